@@ -1,4 +1,6 @@
 from pyLDAP.ldapdn import LDAPDN
 from pyLDAP.ldapurl import LDAPURL
 from pyLDAP._cpyLDAP import LDAPClient
-from pyLDAP._cpyLDAP import LDAPEntry
\ No newline at end of file
+from pyLDAP._cpyLDAP import LDAPEntry
+from pyLDAP._cpyLDAP import LDAPFrozenEntry
+from pyLDAP._cpyLDAP import LDAPResultSet
\ No newline at end of file
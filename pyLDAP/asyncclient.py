@@ -0,0 +1,132 @@
+import asyncio
+
+from pyLDAP._cpyLDAP import LDAPClient
+
+class AsyncLDAPClient(object):
+    __slots__ = ("__client", "__loop", "__pending", "__fd")
+
+    def __init__(self, url="ldap://localhost/", tls=False, loop=None):
+        """
+            Asynchronous LDAP client for asyncio applications. The operations
+            are sent without blocking, the socket of the connection is watched
+            by the event loop, and the responses are collected when they arrive,
+            so many operations can share one connection.
+            :param url: String representation of a valid LDAP URL.
+            :param tls: Start TLS session after connecting.
+            :param loop: The event loop. If None, the running loop is used.
+        """
+        self.__client = LDAPClient(url, tls)
+        self.__loop = loop
+        self.__pending = {}
+        self.__fd = None
+
+    @property
+    def client(self):
+        """ The underlying (synchronous) LDAPClient. """
+        return self.__client
+
+    @property
+    def url(self):
+        """ The LDAP URL of the client. """
+        return self.__client.url
+
+    async def connect(self, *args, **kwargs):
+        """
+            Opens the connection to the server and binds. The binding runs
+            in the default executor, the arguments are the same as the
+            LDAPClient.connect method's.
+        """
+        if self.__loop is None:
+            self.__loop = asyncio.get_running_loop()
+        await self.__loop.run_in_executor(None,
+                                          lambda: self.__client.connect(*args, **kwargs))
+        self.__fd = self.__client.fileno()
+        self.__loop.add_reader(self.__fd, self.__process)
+
+    async def close(self):
+        """ Closes the connection, the pending operations are cancelled. """
+        if self.__fd is not None:
+            self.__loop.remove_reader(self.__fd)
+            self.__fd = None
+        for fut in self.__pending.values():
+            fut.cancel()
+        self.__pending.clear()
+        self.__client.close()
+
+    def __process(self):
+        """ Collects the arrived responses of the pending operations. """
+        for msgid in self.__client.poll():
+            fut = self.__pending.pop(msgid, None)
+            try:
+                result = self.__client.result(msgid)
+            except Exception as exc:
+                if fut is not None and not fut.done():
+                    fut.set_exception(exc)
+                continue
+            if fut is not None and not fut.done():
+                fut.set_result(result)
+
+    def __wait(self, msgid):
+        """ Returns a future of the `msgid` operation's result. """
+        fut = self.__loop.create_future()
+        self.__pending[msgid] = fut
+        # The response could be arrived already.
+        self.__process()
+        return fut
+
+    async def search(self, *args, **kwargs):
+        """
+            Searches for LDAP entries. The arguments are the same as the
+            LDAPClient.search method's. Returns a list of LDAPEntries.
+        """
+        return await self.__wait(self.__client.send_search(*args, **kwargs))
+
+    async def get_entry(self, dn):
+        """
+            Returns an LDAPEntry with the given distinguished name, or
+            None if the entry doesn't exist.
+        """
+        entries = await self.search(dn, 0, attrlist=["*"])
+        if len(entries) == 0:
+            return None
+        return entries[0]
+
+    def __check_entry(self, entry):
+        """
+            The entry's requests are sent through its own client, so only
+            the responses of the entries bound to the underlying client
+            can be collected.
+        """
+        if entry.client is not self.__client:
+            raise ValueError("The LDAPEntry has to be bound to the client property "
+                             "of the AsyncLDAPClient.")
+
+    async def add(self, entry):
+        """ Adds the `entry` LDAPEntry to the server. """
+        self.__check_entry(entry)
+        return await self.__wait(entry.send_add())
+
+    async def modify(self, entry):
+        """ Sends the modifications of the `entry` LDAPEntry to the server. """
+        self.__check_entry(entry)
+        return await self.__wait(entry.send_modify())
+
+    async def delete(self, dn):
+        """ Deletes the entry with the `dn` distinguished name. """
+        return await self.__wait(self.__client.send_delete(str(dn)))
+
+    async def rename(self, entry, newdn):
+        """ Renames (or moves) the `entry` LDAPEntry to `newdn`. """
+        self.__check_entry(entry)
+        return await self.__wait(entry.send_rename(newdn))
+
+    async def compare(self, dn, attr, value):
+        """
+            Returns True, if the entry with the `dn` distinguished name
+            has the `value` for the `attr` attribute, False otherwise.
+        """
+        return await self.__wait(self.__client.send_compare(str(dn), attr, value))
+
+    async def whoami(self):
+        """ LDAPv3 Who Am I operation. """
+        return await self.__wait(self.__client.send_whoami())
@@ -0,0 +1,111 @@
+#include "attrlayout.h"
+
+/*	Deallocate the AttrLayout. */
+static void
+AttrLayout_dealloc(AttrLayout *self) {
+	Py_ssize_t i;
+
+	CaseIndex_Clear(&self->index);
+	for (i = 0; i < self->used; i++) {
+		Py_DECREF(self->items[i].name);
+	}
+	free(self->items);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/*	Creates a new, empty AttrLayout for internal use. */
+AttrLayout *
+AttrLayout_New(void) {
+	return (AttrLayout *)AttrLayoutType.tp_alloc(&AttrLayoutType, 0);
+}
+
+/*	Returns 1, if the `item` is the `len` long `attr` name, 0 otherwise. */
+static int
+match_item(AttrLayoutItem *item, const char *attr, Py_ssize_t len) {
+	return item->len == len && memcmp(item->str, attr, len) == 0;
+}
+
+/*	Adds the new `name` to the layout. Returns 0 on success, -1 otherwise. */
+static int
+add_name(AttrLayout *self, PyObject *name) {
+	AttrLayoutItem *tmp;
+	const char *str;
+	Py_ssize_t len;
+
+	str = PyUnicode_AsUTF8AndSize(name, &len);
+	if (str == NULL) return -1;
+	if (self->used == self->size) {
+		self->size = (self->size == 0) ? 16 : self->size * 2;
+		tmp = (AttrLayoutItem *)realloc(self->items, sizeof(AttrLayoutItem) * self->size);
+		if (tmp == NULL) {
+			PyErr_NoMemory();
+			return -1;
+		}
+		self->items = tmp;
+	}
+	if (CaseIndex_Lookup(&self->index, name) == NULL
+			&& CaseIndex_Insert(&self->index, name) != 0) return -1;
+	Py_INCREF(name);
+	self->items[self->used].name = name;
+	self->items[self->used].str = str;
+	self->items[self->used].len = len;
+	self->used++;
+	return 0;
+}
+
+/*	Returns the string object (new reference) of the `len` long UTF-8 `attr` name, which
+	is the `pos`th attribute of the current entry. The `pos`th name of the layout is
+	tried first, then the others. An unknown name is created and added to the layout.
+	If `self` is NULL, a new string is returned.
+*/
+PyObject *
+AttrLayout_GetName(AttrLayout *self, Py_ssize_t pos, const char *attr, Py_ssize_t len) {
+	Py_ssize_t i;
+	PyObject *name;
+
+	if (self == NULL) return PyUnicode_DecodeUTF8(attr, len, NULL);
+	if (pos < self->used && match_item(&self->items[pos], attr, len)) {
+		name = self->items[pos].name;
+		Py_INCREF(name);
+		return name;
+	}
+	for (i = 0; i < self->used; i++) {
+		if (match_item(&self->items[i], attr, len)) {
+			name = self->items[i].name;
+			Py_INCREF(name);
+			return name;
+		}
+	}
+
+	name = PyUnicode_DecodeUTF8(attr, len, NULL);
+	if (name == NULL) return NULL;
+	if (self->used < _LDAP_LAYOUT_MAXSIZE && add_name(self, name) != 0) {
+		Py_DECREF(name);
+		return NULL;
+	}
+	return name;
+}
+
+PyTypeObject AttrLayoutType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	"pyLDAP.AttrLayout",		/* tp_name */
+	sizeof(AttrLayout),			/* tp_basicsize */
+	0,							/* tp_itemsize */
+	(destructor)AttrLayout_dealloc, /* tp_dealloc */
+	0,							/* tp_print */
+	0,							/* tp_getattr */
+	0,							/* tp_setattr */
+	0,							/* tp_reserved */
+	0,							/* tp_repr */
+	0,							/* tp_as_number */
+	0,							/* tp_as_sequence */
+	0,							/* tp_as_mapping */
+	0,							/* tp_hash */
+	0,							/* tp_call */
+	0,							/* tp_str */
+	0,							/* tp_getattro */
+	0,							/* tp_setattro */
+	0,							/* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,			/* tp_flags */
+	"Shared attribute names of a search result.", /* tp_doc */
+};
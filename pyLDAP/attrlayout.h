@@ -0,0 +1,35 @@
+#ifndef ATTRLAYOUT_H_
+#define ATTRLAYOUT_H_
+
+#include <Python.h>
+
+#include "caseindex.h"
+
+/* The maximal number of the names in a layout, the others are not shared. */
+#define _LDAP_LAYOUT_MAXSIZE 256
+
+typedef struct {
+	PyObject *name;
+	const char *str;
+	Py_ssize_t len;
+} AttrLayoutItem;
+
+/*	Attribute names shared by the entries of a search result. The entries of a
+	result usually have the same attributes in the same order, so every name is
+	created only once, and the same string objects are used as the entries' keys.
+	The names are indexed case-insensitively for the read-only entries.
+*/
+typedef struct {
+	PyObject_HEAD
+	AttrLayoutItem *items;
+	Py_ssize_t used;
+	Py_ssize_t size;
+	CaseIndex index;
+} AttrLayout;
+
+extern PyTypeObject AttrLayoutType;
+
+AttrLayout *AttrLayout_New(void);
+PyObject *AttrLayout_GetName(AttrLayout *self, Py_ssize_t pos, const char *attr, Py_ssize_t len);
+
+#endif /* ATTRLAYOUT_H_ */
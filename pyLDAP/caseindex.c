@@ -0,0 +1,196 @@
+#include "utils.h"
+
+#include "caseindex.h"
+
+#define CASEINDEX_MINSIZE 8
+
+/*	Calculates the case-insensitive FNV-1a hash of the `len` long `str`. */
+static Py_hash_t
+case_hash(const char *str, Py_ssize_t len) {
+	Py_ssize_t i;
+	size_t hash = (size_t)14695981039346656037ULL;
+	unsigned char c;
+
+	for (i = 0; i < len; i++) {
+		c = (unsigned char)str[i];
+		if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+		hash = (hash ^ c) * (size_t)1099511628211ULL;
+	}
+	return (Py_hash_t)hash;
+}
+
+/*	Returns the position of the `key` in the table, or the position of the
+	empty slot where it should be inserted. Sets the `found` parameter to 1,
+	if the key is in the table, 0 otherwise. Returns -1 on error.
+*/
+static Py_ssize_t
+find_slot(CaseIndex *index, PyObject *key, Py_hash_t *hash, int *found) {
+	int match;
+	Py_ssize_t i, len, klen;
+	Py_ssize_t mask = index->size - 1;
+	const char *str, *kstr;
+	char *tofree, *ktofree;
+	CaseIndexEntry *entry;
+
+	str = PyObject2buffer(key, &len, &tofree);
+	if (str == NULL) return -1;
+	*hash = case_hash(str, len);
+	*found = 0;
+	if (index->table == NULL) {
+		free(tofree);
+		return 0;
+	}
+
+	for (i = (size_t)*hash & mask; ; i = (i + 1) & mask) {
+		entry = &index->table[i];
+		if (entry->key == NULL) break;
+		if (entry->hash != *hash) continue;
+		if (entry->key == key) {
+			*found = 1;
+			break;
+		}
+		kstr = PyObject2buffer(entry->key, &klen, &ktofree);
+		if (kstr == NULL) {
+			free(tofree);
+			return -1;
+		}
+		match = (klen == len && asciiCaseEqual(kstr, str, len));
+		free(ktofree);
+		if (match) {
+			*found = 1;
+			break;
+		}
+	}
+	free(tofree);
+	return i;
+}
+
+/*	Reallocates the table with the `size` number of slots. */
+static int
+resize(CaseIndex *index, Py_ssize_t size) {
+	Py_ssize_t i, j;
+	CaseIndexEntry *old = index->table;
+	Py_ssize_t oldsize = index->size;
+
+	index->table = (CaseIndexEntry *)PyMem_Malloc(sizeof(CaseIndexEntry) * size);
+	if (index->table == NULL) {
+		index->table = old;
+		PyErr_NoMemory();
+		return -1;
+	}
+	memset(index->table, 0, sizeof(CaseIndexEntry) * size);
+	index->size = size;
+	for (i = 0; i < oldsize; i++) {
+		if (old[i].key == NULL) continue;
+		for (j = (size_t)old[i].hash & (size - 1);
+				index->table[j].key != NULL; j = (j + 1) & (size - 1));
+		index->table[j] = old[i];
+	}
+	PyMem_Free(old);
+	return 0;
+}
+
+/*	Releases the stored keys and the table. */
+void
+CaseIndex_Clear(CaseIndex *index) {
+	Py_ssize_t i;
+	CaseIndexEntry *table = index->table;
+	Py_ssize_t size = index->size;
+
+	index->table = NULL;
+	index->size = 0;
+	index->used = 0;
+	if (table == NULL) return;
+	for (i = 0; i < size; i++) {
+		Py_XDECREF(table[i].key);
+	}
+	PyMem_Free(table);
+}
+
+/*	Visits the stored keys for the garbage collector. */
+int
+CaseIndex_Traverse(CaseIndex *index, visitproc visit, void *arg) {
+	Py_ssize_t i;
+
+	if (index->table == NULL) return 0;
+	for (i = 0; i < index->size; i++) {
+		Py_VISIT(index->table[i].key);
+	}
+	return 0;
+}
+
+/*	Returns the stored key (borrowed reference), which is a case-insensitive
+	match of the `key`, or NULL if there is no match. On error, returns
+	NULL and sets an exception.
+*/
+PyObject *
+CaseIndex_Lookup(CaseIndex *index, PyObject *key) {
+	int found;
+	Py_hash_t hash;
+	Py_ssize_t i;
+
+	if (index->used == 0) return NULL;
+	i = find_slot(index, key, &hash, &found);
+	if (i == -1 || found == 0) return NULL;
+	return index->table[i].key;
+}
+
+/*	Inserts the `key` into the index. A stored case-insensitive
+	match is replaced. Returns 0 on success, -1 on error.
+*/
+int
+CaseIndex_Insert(CaseIndex *index, PyObject *key) {
+	int found;
+	Py_hash_t hash;
+	Py_ssize_t i;
+	PyObject *tmp;
+
+	/* Keep the load factor under 2/3. */
+	if ((index->used + 1) * 3 >= index->size * 2) {
+		if (resize(index, index->size > 0 ? index->size * 2 : CASEINDEX_MINSIZE) != 0) return -1;
+	}
+	i = find_slot(index, key, &hash, &found);
+	if (i == -1) return -1;
+
+	tmp = index->table[i].key;
+	Py_INCREF(key);
+	index->table[i].hash = hash;
+	index->table[i].key = key;
+	if (found) {
+		Py_DECREF(tmp);
+	} else {
+		index->used++;
+	}
+	return 0;
+}
+
+/*	Removes the case-insensitive match of the `key` from the index.
+	Returns 1 if it is removed, 0 if it is not found, and -1 on error.
+*/
+int
+CaseIndex_Remove(CaseIndex *index, PyObject *key) {
+	int found;
+	Py_hash_t hash;
+	Py_ssize_t i, j, k;
+	Py_ssize_t mask = index->size - 1;
+	PyObject *tmp;
+
+	if (index->used == 0) return 0;
+	i = find_slot(index, key, &hash, &found);
+	if (i == -1) return -1;
+	if (found == 0) return 0;
+
+	tmp = index->table[i].key;
+	/* Shift back the following entries of the probe sequence, instead of
+	   leaving a deleted marker in the slot. */
+	for (j = (i + 1) & mask; index->table[j].key != NULL; j = (j + 1) & mask) {
+		k = (size_t)index->table[j].hash & mask;
+		if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;
+		index->table[i] = index->table[j];
+		i = j;
+	}
+	index->table[i].key = NULL;
+	index->used--;
+	Py_DECREF(tmp);
+	return 1;
+}
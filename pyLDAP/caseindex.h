@@ -0,0 +1,29 @@
+#ifndef CASEINDEX_H_
+#define CASEINDEX_H_
+
+#include <Python.h>
+
+/*	Open-addressing hash set of Python objects, where the objects are
+	compared by their string representations ASCII case-insensitively.
+	It is used for finding the stored form of an attribute name or a value
+	without iterating over every item. A zero-filled CaseIndex is a valid
+	empty index.
+*/
+typedef struct {
+	Py_hash_t hash;
+	PyObject *key;
+} CaseIndexEntry;
+
+typedef struct {
+	Py_ssize_t size;
+	Py_ssize_t used;
+	CaseIndexEntry *table;
+} CaseIndex;
+
+void CaseIndex_Clear(CaseIndex *index);
+int CaseIndex_Traverse(CaseIndex *index, visitproc visit, void *arg);
+PyObject *CaseIndex_Lookup(CaseIndex *index, PyObject *key);
+int CaseIndex_Insert(CaseIndex *index, PyObject *key);
+int CaseIndex_Remove(CaseIndex *index, PyObject *key);
+
+#endif /* CASEINDEX_H_ */
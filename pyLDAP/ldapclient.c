@@ -1,11 +1,35 @@
 #include "ldapclient.h"
 #include "ldapentry.h"
+#include "ldapresultset.h"
+#include "ldapsearchiter.h"
+#include "ldapvalueiter.h"
+#include "uniquelist.h"
 #include "utils.h"
 
+/*	The collected results (and a custom url object) can refer back to the client. */
+static int
+LDAPClient_clear(LDAPClient *self) {
+	Py_CLEAR(self->url);
+	Py_CLEAR(self->results);
+	return 0;
+}
+
+static int
+LDAPClient_traverse(LDAPClient *self, visitproc visit, void *arg) {
+	Py_VISIT(self->url);
+	Py_VISIT(self->results);
+	return 0;
+}
+
 /*	Dealloc the LDAPClient object. */
 static void
 LDAPClient_dealloc(LDAPClient* self) {
-    Py_XDECREF(self->url);
+    PyObject_GC_UnTrack(self);
+    LDAPClient_clear(self);
+    Py_XDECREF(self->pending);
+    Py_XDECREF(self->search_flags);
+    Py_XDECREF(self->decode_policies);
+    ValueCache_Clear(&self->valuecache);
     Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
@@ -22,6 +46,30 @@ LDAPClient_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
             Py_DECREF(self);
             return NULL;
         }
+        /* Create an empty dict for the results of the asynchronous operations. */
+        self->results = PyDict_New();
+        if (self->results == NULL) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        /* Create an empty set for the message ids of the pending operations. */
+        self->pending = PySet_New(NULL);
+        if (self->pending == NULL) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        /* Create an empty dict for the entry flags of the sent searches. */
+        self->search_flags = PyDict_New();
+        if (self->search_flags == NULL) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        /* Create an empty dict for the decoding policies set by the user. */
+        self->decode_policies = PyDict_New();
+        if (self->decode_policies == NULL) {
+            Py_DECREF(self);
+            return NULL;
+        }
 	}
 	self->connected = 0;
 	self->tls = 0;
@@ -43,7 +91,7 @@ LDAPClient_init(LDAPClient *self, PyObject *args, PyObject *kwds) {
     	return -1;
     }
 
-    ldapurl_type = load_python_object("pyLDAP.ldapurl", "LDAPURL");
+    ldapurl_type = get_ldapurl_type();
     if (ldapurl_type == NULL) return -1;
 
     ldapurl = PyObject_CallFunction(ldapurl_type, "s", urlstr);
@@ -63,7 +111,6 @@ LDAPClient_init(LDAPClient *self, PyObject *args, PyObject *kwds) {
 	if (PyUnicode_CompareWithASCIIString(scheme, "ldaps") == 0) {
 		self->tls = 0;
 	}
-	Py_DECREF(ldapurl_type);
 	Py_DECREF(scheme);
     return 0;
 }
@@ -91,19 +138,24 @@ LDAPClient_Connect(LDAPClient *self, PyObject *args, PyObject *kwds) {
 
 	if (rc != LDAP_SUCCESS) {
 		PyObject *ldaperror = get_error_by_code(rc);
-		PyErr_SetString(ldaperror, ldap_err2string(rc));
-		Py_DECREF(ldaperror);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
 		return NULL;
 	}
 
 	/* Start TLS, if it necessary. */
 	if (self->tls == 1) {
+		LDAPCLIENT_BEGIN_CALL(self, return NULL)
 		rc = ldap_start_tls_s(self->ld, NULL, NULL);
+		LDAPCLIENT_END_CALL(self)
 		if (rc != LDAP_SUCCESS) {
-			//TODO Proper errors
-			PyObject *ldaperror = get_error("LDAPError");
-			PyErr_SetString(ldaperror, ldap_err2string(rc));
-			Py_DECREF(ldaperror);
+			PyObject *ldaperror = get_error_by_code(rc);
+			if (ldaperror != NULL) {
+				PyErr_SetString(ldaperror, ldap_err2string(rc));
+				Py_DECREF(ldaperror);
+			}
 			return NULL;
 		}
 	}
@@ -112,30 +164,67 @@ LDAPClient_Connect(LDAPClient *self, PyObject *args, PyObject *kwds) {
 
 	if (rc != LDAP_SUCCESS) {
 		PyObject *ldaperror = get_error_by_code(rc);
-		PyErr_SetString(ldaperror, ldap_err2string(rc));
-		Py_DECREF(ldaperror);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
 		return NULL;
 	}
 
 	self->connected = 1;
-	return Py_None;
+	Py_RETURN_NONE;
 }
 
-/*	Close connection. */
+/*	Close connection. The client cannot be closed, while another thread is waiting
+	for the server in one of its calls. The handle is detached from the client before
+	the GIL is released, so the other threads get NotConnected instead of a freed handle. */
 static PyObject *
 LDAPClient_Close(LDAPClient *self, PyObject *args, PyObject *kwds) {
 	int rc;
+	LDAP *ld;
+
 	if (self->connected) {
-		rc = _LDAP_unbind(self->ld);
-		if (rc != LDAP_SUCCESS) {
+		if (self->busy > 0) {
 			PyObject *ldaperror = get_error("LDAPError");
-			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			PyErr_SetString(ldaperror, "The client is in use by another thread.");
 			Py_DECREF(ldaperror);
 			return NULL;
 		}
+		ld = self->ld;
+		self->ld = NULL;
 		self->connected = 0;
+		/* The pending operations are lost with the connection. */
+		PySet_Clear(self->pending);
+		PyDict_Clear(self->search_flags);
+		PyDict_Clear(self->results);
+
+		Py_BEGIN_ALLOW_THREADS
+		rc = _LDAP_unbind(ld);
+		Py_END_ALLOW_THREADS
+		if (rc != LDAP_SUCCESS) {
+			PyObject *ldaperror = get_error_by_code(rc);
+			if (ldaperror != NULL) {
+				PyErr_SetString(ldaperror, ldap_err2string(rc));
+				Py_DECREF(ldaperror);
+			}
+			return NULL;
+		}
+	}
+	Py_RETURN_NONE;
+}
+
+/*	Marks the client busy before its handle is used without the GIL. Returns -1 with
+	NotConnected set, if the handle has been already released by close(). */
+int
+LDAPClient_BeginCall(LDAPClient *self) {
+	if (self->ld == NULL) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return -1;
 	}
-	return Py_None;
+	self->busy++;
+	return 0;
 }
 
 /*	Delete an entry with the `dnstr` distinguished name on the server. */
@@ -151,12 +240,15 @@ LDAPClient_DelEntryStringDN(LDAPClient *self, char *dnstr) {
 	}
 
 	if (dnstr != NULL) {
+		LDAPCLIENT_BEGIN_CALL(self, return -1)
 		rc = ldap_delete_ext_s(self->ld, dnstr, NULL, NULL);
+		LDAPCLIENT_END_CALL(self)
 		if (rc != LDAP_SUCCESS) {
-			//TODO proper errors
-			PyObject *ldaperror = get_error("LDAPError");
-			PyErr_SetString(ldaperror, ldap_err2string(rc));
-			Py_DECREF(ldaperror);
+			PyObject *ldaperror = get_error_by_code(rc);
+			if (ldaperror != NULL) {
+				PyErr_SetString(ldaperror, ldap_err2string(rc));
+				Py_DECREF(ldaperror);
+			}
 			return -1;
 		}
 	}
@@ -164,112 +256,289 @@ LDAPClient_DelEntryStringDN(LDAPClient *self, char *dnstr) {
 }
 
 static PyObject *
-LDAPClient_DelEntry(LDAPClient *self, PyObject *args, PyObject *kwds) {
+LDAPClient_DelEntry(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
 	char *dnstr = NULL;
+	PyObject *values[1];
 	static char *kwlist[] = {"dn", NULL};
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &dnstr)) {
+	if (unpack_args("del_entry", args, nargs, kwnames, kwlist, 1, values) != 0
+			|| arg2string(values[0], 0, &dnstr) != 0) {
 		PyErr_SetString(PyExc_AttributeError, "Wrong parameter.");
 		return NULL;
 	}
 
 	if (LDAPClient_DelEntryStringDN(self, dnstr) != 0) return NULL;
-	return Py_None;
+	Py_RETURN_NONE;
 }
 
-/*	LDAP search function for internal use. Returns a Python list of LDAPEntries.
-	The `basestr` is the base DN of the searching, `scope` is the search scope (BASE|ONELEVEL|SUB),
-	`filterstr` is the LDAP search filter string, `attrs` is a null-terminated string list of attributes'
-	names to get only the selected attributes. If `attrsonly` is 1 get only attributes' name without values.
-	If `firstonly` is 1, get only the first LDAP entry of the messages. The `timeout` is an integer of
-	seconds for timelimit, `sizelimit` is a limit for size.
-*/
-PyObject *
-searching(LDAPClient *self, char *basestr, int scope, char *filterstr, char **attrs,
-		int attrsonly, int firstonly, int timeout, int sizelimit) {
-	int rc;
-	struct timeval *timelimit;
-	LDAPMessage *res, *entry;
-	PyObject *entrylist;
-	LDAPEntry *entryobj;
+/*	Returns a new UniqueList of the items of the `values` sequence without
+	their case-insensitive duplicates. */
+static PyObject *
+unique_values(PyObject *values) {
+	Py_ssize_t i;
+	PyObject *seq;
+	UniqueList *list;
 
-	entrylist = PyList_New(0);
-	if (entrylist == NULL) {
-		return PyErr_NoMemory();
+	seq = PySequence_Fast(values, "The values must be a sequence.");
+	if (seq == NULL) return NULL;
+	list = UniqueList_New();
+	for (i = 0; list != NULL && i < PySequence_Fast_GET_SIZE(seq); i++) {
+		if (UniqueList_Append(list, PySequence_Fast_GET_ITEM(seq, i)) != 0) {
+			if (PyErr_ExceptionMatches(PyExc_ValueError)) {
+				PyErr_Clear();
+			} else {
+				Py_CLEAR(list);
+			}
+		}
 	}
+	Py_DECREF(seq);
+	return (PyObject *)list;
+}
 
-	/* Create a timeval, and set tv_sec to timeout, if timeout greater than 0. */
-	if (timeout > 0) {
-		timelimit = malloc(sizeof(struct timeval));
-		if (timelimit != NULL) {
-			timelimit->tv_sec = timeout;
-			timelimit->tv_usec = 0;
-		}
-	} else {
-		timelimit = NULL;
+/*	Adds and removes values of an attribute with a single modify request, without getting
+	the current values of the entry. The empty value lists are skipped. The request is sent
+	with the Permissive Modify control, so the already existing values to add and the missing
+	values to remove are ignored by the server (instead of rejecting the whole request). */
+static PyObject *
+LDAPClient_ModifyValues(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int rc, i, n = 0;
+	char *dnstr = NULL;
+	char permissive_oid[] = "1.2.840.113556.1.4.1413";
+	LDAPMod *mods[3];
+	LDAPControl permissive;
+	LDAPControl *server_ctrls[2] = {&permissive, NULL};
+	LDAPArena arena;
+	PyObject *values[4];
+	PyObject *list;
+	static int ops[2] = {LDAP_MOD_ADD | LDAP_MOD_BVALUES, LDAP_MOD_DELETE | LDAP_MOD_BVALUES};
+	static char *kwlist[] = {"dn", "attr", "add", "remove", NULL};
+
+	if (!self->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
 	}
 
-	/* If empty filter string is given, set to NULL. */
-	if (filterstr == NULL || strlen(filterstr) == 0) filterstr = NULL;
-	rc = ldap_search_ext_s(self->ld, basestr, scope, filterstr, attrs, attrsonly, NULL,
-						NULL, timelimit, sizelimit, &res);
+	if (unpack_args("modify_values", args, nargs, kwnames, kwlist, 2, values) != 0
+			|| arg2string(values[0], 0, &dnstr) != 0) return NULL;
+	if (!PyUnicode_Check(values[1])) {
+		PyErr_SetString(PyExc_TypeError, "The attribute name must be a string.");
+		return NULL;
+	}
 
-	if (rc == LDAP_NO_SUCH_OBJECT) {
-		free(timelimit);
-		if (firstonly) {
-			Py_DECREF(entrylist);
+	arena_init(&arena);
+	for (i = 0; i < 2; i++) {
+		if (values[i + 2] == NULL || values[i + 2] == Py_None) continue;
+		/* A duplicated value would be rejected even with the Permissive Modify control. */
+		list = unique_values(values[i + 2]);
+		if (list == NULL) {
+			arena_free(&arena);
 			return NULL;
-		} else {
-			return entrylist;
 		}
+		mods[n] = createLDAPModFromItem(&arena, ops[i], values[1], list);
+		Py_DECREF(list);
+		if (mods[n] == NULL) {
+			arena_free(&arena);
+			return NULL;
+		}
+		/* A delete without values would remove the whole attribute. */
+		if (mods[n]->mod_vals.modv_bvals[0] != NULL) n++;
+	}
+	mods[n] = NULL;
+
+	/* Not critical: without the control's support, the server applies the strict semantics. */
+	permissive.ldctl_oid = permissive_oid;
+	permissive.ldctl_value.bv_len = 0;
+	permissive.ldctl_value.bv_val = NULL;
+	permissive.ldctl_iscritical = 0;
+
+	rc = LDAP_SUCCESS;
+	if (n > 0) {
+		LDAPCLIENT_BEGIN_CALL(self, { arena_free(&arena); return NULL; })
+		rc = ldap_modify_ext_s(self->ld, dnstr, mods, server_ctrls, NULL);
+		LDAPCLIENT_END_CALL(self)
 	}
+	arena_free(&arena);
 	if (rc != LDAP_SUCCESS) {
-		Py_DECREF(entrylist);
-		free(timelimit);
-		//TODO proper errors
-		PyObject *ldaperror = get_error("LDAPError");
-		PyErr_SetString(ldaperror, ldap_err2string(rc));
-		Py_DECREF(ldaperror);
-        return NULL;
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+/*	Returns an empty search result: an empty LDAPResultSet with the
+	_LDAP_ENTRY_COLUMNAR flag, an empty list otherwise. */
+static PyObject *
+empty_result(LDAPClient *self, int flags) {
+	if (flags & _LDAP_ENTRY_COLUMNAR) return (PyObject *)LDAPResultSet_New(self);
+	return PyList_New(0);
+}
+
+/*	Copies the entries of a search result chain into a new LDAPResultSet.
+	The function takes the ownership of the `res` chain. */
+static PyObject *
+resultset_from_result(LDAPClient *self, LDAPMessage *res) {
+	LDAPMessage *entry;
+	LDAPResultSet *resultset;
+
+	resultset = LDAPResultSet_New(self);
+	if (resultset != NULL) {
+		for (entry = ldap_first_entry(self->ld, res);
+			entry != NULL;
+			entry = ldap_next_entry(self->ld, entry)) {
+			if (LDAPResultSet_AddEntry(resultset, entry) != 0) {
+				Py_CLEAR(resultset);
+				break;
+			}
+		}
 	}
+	ldap_msgfree(res);
+	return (PyObject *)resultset;
+}
+
+/*	Converts the entries of a search result chain to a Python list of LDAPEntries.
+	If `firstonly` is 1, returns only the first LDAPEntry (or an empty list).
+	The function takes the ownership of the `res` chain. With the _LDAP_ENTRY_LAZY flag
+	the chain is kept alive by the entries, which decode their values on first access.
+	With the _LDAP_ENTRY_FROZEN flag the list contains read-only LDAPFrozenEntries.
+	With the _LDAP_ENTRY_COLUMNAR flag an LDAPResultSet is returned instead of the list.
+*/
+static PyObject *
+entries_from_result(LDAPClient *self, LDAPMessage *res, int firstonly, int flags) {
+	LDAPMessage *entry;
+	PyObject *entrylist;
+	PyObject *msgowner = NULL;
+	PyObject *entryobj;
+	AttrLayout *layout;
+
+	if (flags & _LDAP_ENTRY_COLUMNAR) return resultset_from_result(self, res);
+
+	/* The entries share the attributes' names. */
+	layout = AttrLayout_New();
+	if (layout == NULL) {
+		ldap_msgfree(res);
+		return NULL;
+	}
+	if (flags & _LDAP_ENTRY_LAZY) {
+		msgowner = LDAPMessage2PyCapsule(res);
+		if (msgowner == NULL) {
+			Py_DECREF(layout);
+			return NULL;
+		}
+	}
+
+	entrylist = PyList_New(0);
+	if (entrylist == NULL) {
+		PyErr_NoMemory();
+		goto Done;
+	}
+
 	/* Iterate over the response LDAP messages. */
 	for (entry = ldap_first_entry(self->ld, res);
 		entry != NULL;
 		entry = ldap_next_entry(self->ld, entry)) {
-		entryobj = LDAPEntry_FromLDAPMessage(entry, self);
+		entryobj = LDAPEntry_Create(entry, self, flags, msgowner, layout);
 		if (entryobj == NULL) {
-			Py_DECREF(entrylist);
-			free(timelimit);
-			return NULL;
+			Py_CLEAR(entrylist);
+			goto Done;
 		}
 		/* Remove useless LDAPEntry. */
-		if (PyList_Size((PyObject *)entryobj->attributes) == 0) {
+		if (entryobj == Py_None) {
 			Py_DECREF(entryobj);
 			continue;
 		}
 		/* Return with the first entry. */
 		if (firstonly == 1) {
-			free(timelimit);
-			return (PyObject *)entryobj;
+			Py_DECREF(entrylist);
+			entrylist = entryobj;
+			goto Done;
 		}
-		if ((entryobj == NULL) ||
-				(PyList_Append(entrylist, (PyObject *)entryobj)) != 0) {
-			Py_XDECREF(entryobj);
-			Py_XDECREF(entrylist);
-			free(timelimit);
-			return PyErr_NoMemory();
+		if (PyList_Append(entrylist, entryobj) != 0) {
+			Py_DECREF(entryobj);
+			Py_CLEAR(entrylist);
+			PyErr_NoMemory();
+			goto Done;
 		}
 		Py_DECREF(entryobj);
 	}
-	free(timelimit);
+Done:
+	Py_DECREF(layout);
+	if (msgowner != NULL) {
+		Py_DECREF(msgowner);
+	} else {
+		ldap_msgfree(res);
+	}
 	return entrylist;
 }
 
+/*	LDAP search function for internal use. Returns a Python list of LDAPEntries.
+	The `basestr` is the base DN of the searching, `scope` is the search scope (BASE|ONELEVEL|SUB),
+	`filterstr` is the LDAP search filter string, `attrs` is a null-terminated string list of attributes'
+	names to get only the selected attributes. If `attrsonly` is 1 get only attributes' name without values.
+	If `firstonly` is 1, get only the first LDAP entry of the messages. The `timeout` is an integer of
+	seconds for timelimit, `sizelimit` is a limit for size. The `flags` are passed to the entries.
+	The attributes, whose values are sent in more ranges by the server, are completed.
+	The GIL is released while waiting for the server, the Python objects are created only after
+	the whole result has been arrived.
+*/
+PyObject *
+searching(LDAPClient *self, char *basestr, int scope, char *filterstr, char **attrs,
+		int attrsonly, int firstonly, int timeout, int sizelimit, int flags) {
+	int rc;
+	struct timeval timelimit;
+	struct timeval *timelimitp = NULL;
+	LDAPMessage *res = NULL;
+	PyObject *entries;
+
+	/* Set tv_sec to timeout, if timeout greater than 0. */
+	if (timeout > 0) {
+		timelimit.tv_sec = timeout;
+		timelimit.tv_usec = 0;
+		timelimitp = &timelimit;
+	}
+
+	/* If empty filter string is given, set to NULL. */
+	if (filterstr == NULL || strlen(filterstr) == 0) filterstr = NULL;
+	LDAPCLIENT_BEGIN_CALL(self, return NULL)
+	rc = ldap_search_ext_s(self->ld, basestr, scope, filterstr, attrs, attrsonly, NULL,
+						NULL, timelimitp, sizelimit, &res);
+	LDAPCLIENT_END_CALL(self)
+
+	if (rc == LDAP_NO_SUCH_OBJECT) {
+		if (res != NULL) ldap_msgfree(res);
+		if (firstonly) Py_RETURN_NONE;
+		return empty_result(self, flags);
+	}
+	if (rc != LDAP_SUCCESS) {
+		if (res != NULL) ldap_msgfree(res);
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+        return NULL;
+	}
+	entries = entries_from_result(self, res, firstonly, flags);
+	/* Get the rest of the values of the attributes, which are received in ranges. */
+	if (entries != NULL && !(flags & (_LDAP_ENTRY_FROZEN | _LDAP_ENTRY_COLUMNAR))
+			&& LDAPEntry_FetchRanges(self, entries) != 0) {
+		Py_DECREF(entries);
+		return NULL;
+	}
+	return entries;
+}
+
 /*	Return an LDAPEntry of the given distinguished name. */
 static PyObject *
-LDAPClient_GetEntry(LDAPClient *self, PyObject *args, PyObject *kwds) {
+LDAPClient_GetEntry(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
   	char *dnstr;
 	PyObject *entry;
+	PyObject *values[1];
 	static char *kwlist[] = {"dn", NULL};
 
 	if (!self->connected) {
@@ -279,19 +548,41 @@ LDAPClient_GetEntry(LDAPClient *self, PyObject *args, PyObject *kwds) {
 		return NULL;
 	}
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &dnstr)) {
+	if (unpack_args("get_entry", args, nargs, kwnames, kwlist, 1, values) != 0
+			|| arg2string(values[0], 0, &dnstr) != 0) {
 		PyErr_SetString(PyExc_AttributeError, "Wrong parameter.");
 		return NULL;
 	}
 
-	entry = searching(self, dnstr, LDAP_SCOPE_BASE, NULL, NULL, 0, 1, 0, 0);
-	if (entry == NULL) {
-		Py_INCREF(Py_None);
-		return Py_None;
-	}
+	entry = searching(self, dnstr, LDAP_SCOPE_BASE, NULL, NULL, 0, 1, 0, 0, 0);
+	if (entry == NULL && !PyErr_Occurred()) Py_RETURN_NONE;
 	return entry;
 }
 
+/*	Returns an iterator over the values of an entry's attribute, which are retrieved
+	range by range, so the values of a huge attribute are not kept together in memory. */
+static PyObject *
+LDAPClient_IterValues(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	char *dnstr;
+	PyObject *values[2];
+	static char *kwlist[] = {"dn", "attr", NULL};
+
+	if (!self->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+
+	if (unpack_args("iter_values", args, nargs, kwnames, kwlist, 2, values) != 0
+			|| arg2string(values[0], 0, &dnstr) != 0 || !PyUnicode_Check(values[1])) {
+		PyErr_SetString(PyExc_AttributeError, "Wrong parameter.");
+		return NULL;
+	}
+
+	return (PyObject *)LDAPValueIter_New(self, dnstr, values[1], 0);
+}
+
 /* Returns an LDAPEntry of the RootDSE. */
 static PyObject *
 LDAPClient_GetRootDSE(LDAPClient *self) {
@@ -312,95 +603,190 @@ LDAPClient_GetRootDSE(LDAPClient *self) {
 	attrs[4] = "supportedSASLMechanisms";
   	attrs[5] = "supportedLDAPVersion";
   	attrs[6] = NULL;
-  	rootdse = searching(self, "", LDAP_SCOPE_BASE, "(objectclass=*)", attrs, 0, 1, 0, 0);
+  	rootdse = searching(self, "", LDAP_SCOPE_BASE, "(objectclass=*)", attrs, 0, 1, 0, 0, 0);
 	return rootdse;
 }
 
-/* Searches for LDAP entries. */
-static PyObject *
-LDAPClient_Search(LDAPClient *self, PyObject *args, PyObject *kwds) {
-	int scope = -1;
-	int timeout, sizelimit, attrsonly = 0;
-	char *basestr = NULL;
-	char *filterstr = NULL;
-	PyObject *entrylist;
-	PyObject *attrlist  = NULL;
-	PyObject *attrsonlyo = NULL;
-	static char *kwlist[] = {"base", "scope", "filter", "attrlist", "timeout", "sizelimit", "attrsonly", NULL};
+/*	Parses the arguments of the search methods. The unset parameters are filled
+	with the values of the client's LDAP URL. The `attrs` is a null-terminated string list
+	of the requested attributes (or NULL for all of them). The `flags` of the entries are set
+	by the `lazy`, `frozen`, `columnar` and `untracked` keywords.
+	Returns 0 on success, -1 otherwise.
+*/
+static int
+parse_search_args(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+		char **basestr, int *scope, char **filterstr, char ***attrs, int *attrsonly, int *timeout,
+		int *sizelimit, int *page_size, int *flags) {
+	int i;
+	PyObject *attrlist;
+	PyObject *values[12];
+	static char *kwlist[] = {"base", "scope", "filter", "attrlist", "timeout", "sizelimit", "attrsonly",
+			"page_size", "lazy", "frozen", "columnar", "untracked", NULL};
 
 	if (!self->connected) {
 		PyObject *ldaperror = get_error("NotConnected");
 		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
 		Py_DECREF(ldaperror);
-		return NULL;
+		return -1;
 	}
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|sizOiiO!", kwlist, &basestr, &scope, &filterstr,
-    		&attrlist, &timeout, &sizelimit, &PyBool_Type, &attrsonlyo)) {
-		PyErr_SetString(PyExc_AttributeError,
-				"Wrong parameters (base<str>, scope<int>, filter<str>, attrlist<List>, timeout<int>, attrsonly<bool>).");
-        return NULL;
-	}
+    if (unpack_args("search", args, nargs, kwnames, kwlist, 0, values) != 0) goto Wrong;
+    if (values[0] != NULL && arg2string(values[0], 0, basestr) != 0) goto Wrong;
+    if (values[1] != NULL && arg2int(values[1], scope) != 0) goto Wrong;
+    if (values[2] != NULL && arg2string(values[2], 1, filterstr) != 0) goto Wrong;
+    if (values[4] != NULL && arg2int(values[4], timeout) != 0) goto Wrong;
+    if (values[5] != NULL && arg2int(values[5], sizelimit) != 0) goto Wrong;
+    if (values[7] != NULL && arg2int(values[7], page_size) != 0) goto Wrong;
+    /* The attrsonly and the options of the entries are booleans. */
+    for (i = 6; i < 12; i++) {
+    	if (i != 7 && values[i] != NULL && !PyBool_Check(values[i])) goto Wrong;
+    }
+    attrlist = values[3];
 
-    if (basestr == NULL) {
+    if (*basestr == NULL) {
     	PyObject *basedn = PyObject_GetAttrString(self->url, "basedn");
-    	if (basedn == NULL) return NULL;
+    	if (basedn == NULL) return -1;
 
     	if (basedn == Py_None) {
     		Py_DECREF(basedn);
     		PyErr_SetString(PyExc_AttributeError, "Search base DN cannot be None.");
-    		return NULL;
+    		return -1;
     	} else {
-    		basestr = PyObject2char(basedn);
+    		*basestr = PyObject2char(basedn);
     		Py_DECREF(basedn);
-    		if (basestr == NULL) return NULL;
+    		if (*basestr == NULL) return -1;
     	}
     }
 
-    if (scope == -1) {
+    if (*scope == -1) {
     	PyObject *scopeobj = PyObject_GetAttrString(self->url, "scope_num");
-    	if (scopeobj == NULL) return NULL;
+    	if (scopeobj == NULL) return -1;
 
     	if (scopeobj == Py_None) {
     		Py_DECREF(scopeobj);
 			PyErr_SetString(PyExc_AttributeError, "Search scope cannot be None.");
-			return NULL;
+			return -1;
     	} else {
-    		scope = PyLong_AsLong(scopeobj);
+    		*scope = PyLong_AsLong(scopeobj);
 			Py_DECREF(scopeobj);
-			if (scope == -1) return NULL;
+			if (*scope == -1) return -1;
     	}
     }
 
-    if (filterstr == NULL) {
+    if (*filterstr == NULL) {
     	PyObject *filter = PyObject_GetAttrString(self->url, "filter");
-    	if (filter == NULL) return NULL;
+    	if (filter == NULL) return -1;
     	if (filter == Py_None) {
     		Py_DECREF(filter);
     	} else {
-    		filterstr = PyObject2char(filter);
+    		*filterstr = PyObject2char(filter);
     		Py_DECREF(filter);
-    		if (filterstr == NULL) return NULL;
+    		if (*filterstr == NULL) return -1;
     	}
     }
 
-    if (attrsonlyo != NULL) {
-    	attrsonly = PyObject_IsTrue(attrsonlyo);
-	}
+    if (values[6] == Py_True) *attrsonly = 1;
+
+    /* The frozen entries are always decoded at once. */
+    if (values[9] == Py_True) *flags |= _LDAP_ENTRY_FROZEN;
+    else if (values[8] == Py_True) *flags |= _LDAP_ENTRY_LAZY;
+    if (values[10] == Py_True) *flags |= _LDAP_ENTRY_COLUMNAR;
+    if (values[11] == Py_True) *flags |= _LDAP_ENTRY_UNTRACKED;
 
     if (attrlist == NULL) {
     	attrlist = PyObject_GetAttrString(self->url, "attributes");
+    	if (attrlist == NULL) return -1;
+    	*attrs = PyList2StringList(attrlist);
+    	Py_DECREF(attrlist);
+    } else {
+    	*attrs = PyList2StringList(attrlist);
     }
+    if (*attrs == NULL && PyErr_Occurred()) return -1;
+    return 0;
+
+Wrong:
+	PyErr_SetString(PyExc_AttributeError,
+			"Wrong parameters (base<str>, scope<int>, filter<str>, attrlist<List>, timeout<int>, "
+			"sizelimit<int>, attrsonly<bool>, page_size<int>, lazy<bool>, frozen<bool>, "
+			"columnar<bool>, untracked<bool>).");
+	return -1;
+}
+
+/* Searches for LDAP entries. If `page_size` is set, the entries are collected page by page. */
+static PyObject *
+LDAPClient_Search(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int scope = -1;
+	int timeout = 0, sizelimit = 0, attrsonly = 0, page_size = 0, flags = 0;
+	char *basestr = NULL;
+	char *filterstr = NULL;
+	char **attrs = NULL;
+	PyObject *entrylist;
+	PyObject *iter;
+
+	if (parse_search_args(self, args, nargs, kwnames, &basestr, &scope, &filterstr, &attrs,
+			&attrsonly, &timeout, &sizelimit, &page_size, &flags) != 0) {
+		return NULL;
+	}
+
+	if (page_size > 0) {
+		if (flags & _LDAP_ENTRY_COLUMNAR) {
+			free_string_list(attrs);
+			PyErr_SetString(PyExc_ValueError, "The columnar search cannot be paged.");
+			return NULL;
+		}
+		/* The iterator takes the ownership of the attribute list. */
+		iter = (PyObject *)LDAPSearchIter_New(self, basestr, scope, filterstr, attrs,
+				attrsonly, timeout, sizelimit, page_size, flags);
+		if (iter == NULL) return NULL;
+		entrylist = PySequence_List(iter);
+		Py_DECREF(iter);
+		return entrylist;
+	}
 
-	entrylist = searching(self, basestr, scope, filterstr, PyList2StringList(attrlist), attrsonly, 0, timeout, sizelimit);
-	Py_XDECREF(attrlist);
+	entrylist = searching(self, basestr, scope, filterstr, attrs, attrsonly, 0, timeout, sizelimit,
+			flags);
+	free_string_list(attrs);
 	return entrylist;
 }
 
+/*	Returns an iterator of the search's result. The entries are requested with the
+	paged results control, `page_size` entries at once. The next page is requested right after
+	the current one is arrived, so the server is working while the entries are processed.
+	If `page_size` is 0, the entries are returned one by one, as soon as they are arrived.
+*/
+static PyObject *
+LDAPClient_SearchIter(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int scope = -1;
+	int timeout = 0, sizelimit = 0, attrsonly = 0, page_size = 500, flags = 0;
+	char *basestr = NULL;
+	char *filterstr = NULL;
+	char **attrs = NULL;
+
+	if (parse_search_args(self, args, nargs, kwnames, &basestr, &scope, &filterstr, &attrs,
+			&attrsonly, &timeout, &sizelimit, &page_size, &flags) != 0) {
+		return NULL;
+	}
+
+	if (page_size < 0) {
+		free_string_list(attrs);
+		PyErr_SetString(PyExc_ValueError, "The page_size must be a non-negative integer.");
+		return NULL;
+	}
+	if (flags & _LDAP_ENTRY_COLUMNAR) {
+		free_string_list(attrs);
+		PyErr_SetString(PyExc_ValueError, "The search_iter cannot return an LDAPResultSet.");
+		return NULL;
+	}
+
+	return (PyObject *)LDAPSearchIter_New(self, basestr, scope, filterstr, attrs,
+			attrsonly, timeout, sizelimit, page_size, flags);
+}
+
 static PyObject *
 LDAPClient_Whoami(LDAPClient *self) {
 	int rc = -1;
 	struct berval *authzid = NULL;
+	PyObject *result;
 
 	if (!self->connected) {
 		PyObject *ldaperror = get_error("NotConnected");
@@ -408,22 +794,621 @@ LDAPClient_Whoami(LDAPClient *self) {
 		Py_DECREF(ldaperror);
 		return NULL;
 	}
+	LDAPCLIENT_BEGIN_CALL(self, return NULL)
 	rc = ldap_whoami_s(self->ld, &authzid, NULL, NULL);
+	LDAPCLIENT_END_CALL(self)
 	if (rc != LDAP_SUCCESS) {
-		//TODO proper errors
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return NULL;
+	}
+
+	if (authzid == NULL) return PyUnicode_FromString("anonym");
+
+	if(authzid->bv_len == 0) {
+		ber_bvfree(authzid);
+		return PyUnicode_FromString("anonym");
+	}
+	result = PyUnicode_FromStringAndSize(authzid->bv_val, authzid->bv_len);
+	ber_bvfree(authzid);
+	return result;
+}
+
+/*	Returns the socket descriptor of the connection, to watch it with an event loop. */
+static PyObject *
+LDAPClient_Fileno(LDAPClient *self) {
+	int fd = -1;
+
+	if (!self->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+
+	if (ldap_get_option(self->ld, LDAP_OPT_DESC, &fd) != LDAP_OPT_SUCCESS || fd < 0) {
 		PyObject *ldaperror = get_error("LDAPError");
+		PyErr_SetString(ldaperror, "Cannot get the socket descriptor.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+	return PyLong_FromLong((long)fd);
+}
+
+/*	Registers the sent asynchronous operation as pending, and returns its message id
+	as a Python integer, or sets an exception, if the `rc` return code of the sending
+	is not a success.
+*/
+PyObject *
+LDAPClient_SetMsgId(LDAPClient *self, int rc, int msgid) {
+	PyObject *key;
+
+	if (rc != LDAP_SUCCESS) {
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return NULL;
+	}
+	key = PyLong_FromLong((long)msgid);
+	if (key == NULL) return NULL;
+	/* Register as a pending operation. */
+	if (PySet_Add(self->pending, key) != 0) {
+		Py_DECREF(key);
+		return NULL;
+	}
+	return key;
+}
+
+/*	Converts the complete response of an asynchronous operation to a Python object:
+	a list of LDAPEntries for search, a bool for compare, a string for whoami,
+	and None for the others. Returns NULL and sets an exception, if the operation is failed.
+	The function takes the ownership of the `res` chain.
+*/
+static PyObject *
+convert_result(LDAPClient *self, LDAPMessage *res) {
+	int rc, err = LDAP_SUCCESS, flags = 0;
+	int msgtype = ldap_msgtype(res);
+	struct berval *data = NULL;
+	PyObject *key, *flagsobj;
+	PyObject *value = NULL;
+
+	rc = ldap_parse_result(self->ld, res, &err, NULL, NULL, NULL, NULL, 0);
+	if (rc == LDAP_SUCCESS) rc = err;
+
+	switch (msgtype) {
+	case LDAP_RES_SEARCH_ENTRY:
+	case LDAP_RES_SEARCH_REFERENCE:
+	case LDAP_RES_SEARCH_RESULT:
+		key = PyLong_FromLong((long)ldap_msgid(res));
+		if (key == NULL) {
+			ldap_msgfree(res);
+			return NULL;
+		}
+		flagsobj = PyDict_GetItem(self->search_flags, key);
+		if (flagsobj != NULL) {
+			flags = (int)PyLong_AsLong(flagsobj);
+			PyDict_DelItem(self->search_flags, key);
+		}
+		Py_DECREF(key);
+		if (rc == LDAP_NO_SUCH_OBJECT) {
+			ldap_msgfree(res);
+			return empty_result(self, flags);
+		}
+		if (rc != LDAP_SUCCESS) break;
+		return entries_from_result(self, res, 0, flags);
+	case LDAP_RES_COMPARE:
+		ldap_msgfree(res);
+		if (rc == LDAP_COMPARE_TRUE) Py_RETURN_TRUE;
+		if (rc == LDAP_COMPARE_FALSE) Py_RETURN_FALSE;
+		break;
+	case LDAP_RES_EXTENDED:
+		if (rc != LDAP_SUCCESS) break;
+		rc = ldap_parse_extended_result(self->ld, res, NULL, &data, 0);
+		if (rc != LDAP_SUCCESS) break;
+		if (data == NULL || data->bv_len == 0) {
+			value = PyUnicode_FromString("anonym");
+		} else {
+			value = PyUnicode_FromStringAndSize(data->bv_val, data->bv_len);
+		}
+		if (data != NULL) ber_bvfree(data);
+		ldap_msgfree(res);
+		return value;
+	default:
+		if (rc != LDAP_SUCCESS) break;
+		ldap_msgfree(res);
+		Py_RETURN_NONE;
+	}
+	if (msgtype != LDAP_RES_COMPARE) ldap_msgfree(res);
+	PyObject *ldaperror = get_error_by_code(rc);
+	if (ldaperror != NULL) {
 		PyErr_SetString(ldaperror, ldap_err2string(rc));
 		Py_DECREF(ldaperror);
+	}
+	return NULL;
+}
+
+/*	Stores the `value` in the client's results dict with the `msgid` key. If the `value`
+	is NULL, the raised exception is stored, to raise it when the result is asked.
+	The operation is removed from the pending ones. Returns 0 on success, -1 otherwise.
+*/
+static int
+store_result(LDAPClient *self, int msgid, PyObject *value) {
+	int rc;
+	PyObject *key;
+	PyObject *type, *tb;
+
+	if (value == NULL) {
+		PyErr_Fetch(&type, &value, &tb);
+		PyErr_NormalizeException(&type, &value, &tb);
+		if (tb != NULL) {
+			PyException_SetTraceback(value, tb);
+			Py_DECREF(tb);
+		}
+		Py_DECREF(type);
+	}
+	key = PyLong_FromLong((long)msgid);
+	if (key == NULL) {
+		Py_DECREF(value);
+		return -1;
+	}
+	rc = PyDict_SetItem(self->results, key, value);
+	if (rc == 0) rc = PySet_Discard(self->pending, key) < 0 ? -1 : 0;
+	Py_DECREF(key);
+	Py_DECREF(value);
+	return rc;
+}
+
+/*	Collects the response of the `msgid` pending operation without blocking, if it is
+	completely arrived. Every other response, which is read from the socket meanwhile,
+	is kept by libldap for its own operation. Returns 1 if the result is stored,
+	0 if it is not arrived yet, and -1 on error.
+*/
+static int
+dispatch(LDAPClient *self, int msgid) {
+	int rc;
+	struct timeval zero = {0, 0};
+	LDAPMessage *res = NULL;
+
+	rc = ldap_result(self->ld, msgid, LDAP_MSG_ALL, &zero, &res);
+	if (rc == 0) return 0;
+	if (rc < 0) {
+		/* The operation is failed (e.g. the connection is lost), store the error. */
+		ldap_get_option(self->ld, LDAP_OPT_RESULT_CODE, &rc);
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		if (store_result(self, msgid, NULL) != 0) return -1;
+		return 1;
+	}
+	if (store_result(self, msgid, convert_result(self, res)) != 0) return -1;
+	return 1;
+}
+
+/*	Checks, without blocking, that the response of the `msgid` operation is arrived.
+	Without `msgid`, collects the arrived responses of every pending operation, and
+	returns the list of their message ids.
+*/
+static PyObject *
+LDAPClient_Poll(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs) {
+	int rc, msgid = -1;
+	Py_ssize_t i;
+	PyObject *key, *pending, *ready;
+	PyObject *values[1];
+	static char *kwlist[] = {"msgid", NULL};
+
+	if (unpack_args("poll", args, nargs, NULL, kwlist, 0, values) != 0) return NULL;
+	if (values[0] != NULL && arg2int(values[0], &msgid) != 0) return NULL;
+
+	if (msgid != -1) {
+		key = PyLong_FromLong((long)msgid);
+		if (key == NULL) return NULL;
+		rc = PyDict_Contains(self->results, key);
+		Py_DECREF(key);
+		if (rc == 1) Py_RETURN_TRUE;
+		if (rc == -1) return NULL;
+	}
+
+	if (!self->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
 		return NULL;
 	}
 
-	if (authzid == NULL) return PyUnicode_FromString("anonym");
+	if (msgid != -1) {
+		rc = dispatch(self, msgid);
+		if (rc == -1) return NULL;
+		return PyBool_FromLong(rc);
+	}
 
-	if(authzid->bv_len == 0) {
-		authzid->bv_val = "anonym";
-		authzid->bv_len = 6;
+	ready = PyList_New(0);
+	if (ready == NULL) return NULL;
+	pending = PySequence_List(self->pending);
+	if (pending == NULL) {
+		Py_DECREF(ready);
+		return NULL;
+	}
+	for (i = 0; i < PyList_GET_SIZE(pending); i++) {
+		key = PyList_GET_ITEM(pending, i);
+		rc = dispatch(self, (int)PyLong_AsLong(key));
+		if (rc == 1) rc = PyList_Append(ready, key);
+		if (rc == -1) {
+			Py_DECREF(pending);
+			Py_DECREF(ready);
+			return NULL;
+		}
+	}
+	Py_DECREF(pending);
+	return ready;
+}
+
+/*	Returns the result of the `msgid` operation. Waits for the response, if it is not arrived yet.
+	While waiting, the responses of the other pending operations are kept by libldap.
+*/
+static PyObject *
+LDAPClient_Result(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs) {
+	int rc, msgid;
+	LDAPMessage *res = NULL;
+	PyObject *key, *value;
+	PyObject *values[1];
+	static char *kwlist[] = {"msgid", NULL};
+
+	if (unpack_args("result", args, nargs, NULL, kwlist, 1, values) != 0
+			|| arg2int(values[0], &msgid) != 0) return NULL;
+
+	key = PyLong_FromLong((long)msgid);
+	if (key == NULL) return NULL;
+	value = PyDict_GetItem(self->results, key);
+	if (value != NULL) {
+		Py_INCREF(value);
+		PyDict_DelItem(self->results, key);
+		Py_DECREF(key);
+		if (PyExceptionInstance_Check(value)) {
+			PyErr_SetObject((PyObject *)Py_TYPE(value), value);
+			Py_DECREF(value);
+			return NULL;
+		}
+		return value;
+	}
+	if (!self->connected) {
+		Py_DECREF(key);
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+	rc = PySet_Discard(self->pending, key);
+	Py_DECREF(key);
+	if (rc < 0) return NULL;
+	/* Without a timeout, waiting for an unknown (or already collected) id would block forever. */
+	if (rc == 0) {
+		PyErr_Format(PyExc_ValueError, "No pending operation with message id %d.", msgid);
+		return NULL;
+	}
+
+	LDAPCLIENT_BEGIN_CALL(self, return NULL)
+	rc = ldap_result(self->ld, msgid, LDAP_MSG_ALL, NULL, &res);
+	LDAPCLIENT_END_CALL(self)
+	if (rc <= 0) {
+		ldap_get_option(self->ld, LDAP_OPT_RESULT_CODE, &rc);
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return NULL;
+	}
+	return convert_result(self, res);
+}
+
+/*	Returns the message ids of the sent, but not yet collected operations. */
+static PyObject *
+LDAPClient_getPending(LDAPClient *self, void *closure) {
+	return PyFrozenSet_New(self->pending);
+}
+
+/* Attributes with binary syntax, their values are returned as bytes by default. */
+static const char *binary_attributes[] = {"audio", "authorityRevocationList", "cACertificate",
+		"certificateRevocationList", "crossCertificatePair", "deltaRevocationList", "jpegPhoto",
+		"objectGUID", "objectSid", "photo", "sIDHistory", "thumbnailPhoto", "tokenGroups",
+		"userCertificate", "userPKCS12", "userSMIMECertificate", NULL};
+
+static char *policy_names[] = {"auto", "bytes", "str"};
+
+/* The stored flags of an attribute, whose decoding policy is not set explicitly. */
+#define _LDAP_DECODE_UNSET 3
+
+/*	Copies the lower-cased name of the `len` long `attr` attribute without its options
+	into `name`. Returns the length of the name, or -1 if it's longer than the `size`. */
+static Py_ssize_t
+policy_key(const char *attr, Py_ssize_t len, char *name, size_t size) {
+	Py_ssize_t i;
+
+	for (i = 0; i < len && attr[i] != ';'; i++) {
+		if ((size_t)i + 1 >= size) return -1;
+		name[i] = tolower(attr[i]);
 	}
-	return PyUnicode_FromString(authzid->bv_val);
+	name[i] = '\0';
+	return i;
+}
+
+/*	Returns the stored flags of the `name` attribute (decoding policy and interning),
+	or _LDAP_DECODE_UNSET, if nothing is set for it. */
+static int
+stored_flags(LDAPClient *self, const char *name) {
+	PyObject *flags = PyDict_GetItemString(self->decode_policies, name);
+
+	if (flags == NULL) return _LDAP_DECODE_UNSET;
+	return (int)PyLong_AsLong(flags);
+}
+
+/*	Stores the `flags` of the `name` attribute. Returns 0 on success, -1 otherwise. */
+static int
+store_flags(LDAPClient *self, const char *name, int flags) {
+	int rc;
+	PyObject *flagsobj;
+
+	if (flags == _LDAP_DECODE_UNSET) {
+		if (PyDict_GetItemString(self->decode_policies, name) == NULL) return 0;
+		return PyDict_DelItemString(self->decode_policies, name);
+	}
+	flagsobj = PyLong_FromLong(flags);
+	if (flagsobj == NULL) return -1;
+	rc = PyDict_SetItemString(self->decode_policies, name, flagsobj);
+	Py_DECREF(flagsobj);
+	return rc;
+}
+
+/*	Returns the decoding policy of the `len` long `attr` attribute's values: the one set
+	with set_decode_policy, or bytes for the known binary attributes and for the `;binary`
+	transfer option (RFC 4522), auto otherwise. The _LDAP_DECODE_INTERN flag is set, if
+	the attribute's values are interned. The `attr` needn't be null-terminated. */
+int
+LDAPClient_DecodePolicy(LDAPClient *self, const char *attr, Py_ssize_t len) {
+	int i, flags = _LDAP_DECODE_UNSET;
+	Py_ssize_t namelen, start;
+	char name[128];
+
+	for (namelen = 0; namelen < len && attr[namelen] != ';'; namelen++);
+	if (PyDict_Size(self->decode_policies) > 0 && policy_key(attr, len, name, sizeof(name)) >= 0) {
+		flags = stored_flags(self, name);
+		if ((flags & _LDAP_DECODE_MASK) != _LDAP_DECODE_UNSET) return flags;
+	}
+	flags &= _LDAP_DECODE_INTERN;
+	/* Check the options after the name. */
+	for (start = namelen + 1; start < len; start = i + 1) {
+		for (i = start; i < len && attr[i] != ';'; i++);
+		if (i - start == 6 && asciiCaseEqual(attr + start, "binary", 6)) {
+			return _LDAP_DECODE_BYTES | flags;
+		}
+	}
+	for (i = 0; binary_attributes[i] != NULL; i++) {
+		if ((Py_ssize_t)strlen(binary_attributes[i]) == namelen
+				&& asciiCaseEqual(binary_attributes[i], attr, namelen)) {
+			return _LDAP_DECODE_BYTES | flags;
+		}
+	}
+	return _LDAP_DECODE_AUTO | flags;
+}
+
+/*	Converts the `bval` value to a Python object (new reference) with the `policy`
+	returned by LDAPClient_DecodePolicy(). The values of the interned attributes
+	are looked up in the client's cache. */
+PyObject *
+LDAPClient_DecodeValue(LDAPClient *self, struct berval *bval, int policy) {
+	if (policy & _LDAP_DECODE_INTERN) {
+		return ValueCache_Get(&self->valuecache, bval, policy & _LDAP_DECODE_MASK);
+	}
+	return berval2PyObject(bval, policy);
+}
+
+/*	Sets the decoding policy of an attribute's values: "auto" (string if the value is
+	valid UTF-8, bytes otherwise), "bytes", or "str". */
+static PyObject *
+LDAPClient_SetDecodePolicy(LDAPClient *self, PyObject *args) {
+	int i;
+	char *attr = NULL;
+	char *policystr = NULL;
+	char name[128];
+
+	if (!PyArg_ParseTuple(args, "ss", &attr, &policystr)) return NULL;
+
+	for (i = 0; i < 3; i++) {
+		if (strcmp(policystr, policy_names[i]) == 0) break;
+	}
+	if (i == 3) {
+		PyErr_SetString(PyExc_ValueError, "The policy must be 'auto', 'bytes' or 'str'.");
+		return NULL;
+	}
+	if (policy_key(attr, strlen(attr), name, sizeof(name)) <= 0) {
+		PyErr_SetString(PyExc_ValueError, "Invalid attribute name.");
+		return NULL;
+	}
+	/* Keep the interning of the attribute. */
+	if (store_flags(self, name, i | (stored_flags(self, name) & _LDAP_DECODE_INTERN)) != 0) {
+		return NULL;
+	}
+	Py_RETURN_NONE;
+}
+
+/*	Returns the decoding policy of an attribute's values. */
+static PyObject *
+LDAPClient_GetDecodePolicy(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs) {
+	char *attr = NULL;
+	PyObject *values[1];
+	static char *kwlist[] = {"attr", NULL};
+
+	if (unpack_args("get_decode_policy", args, nargs, NULL, kwlist, 1, values) != 0
+			|| arg2string(values[0], 0, &attr) != 0) return NULL;
+
+	return PyUnicode_FromString(policy_names[LDAPClient_DecodePolicy(self, attr, strlen(attr))
+			& _LDAP_DECODE_MASK]);
+}
+
+/*	Enables (or disables) the interning of an attribute's values: the repeated values
+	are returned as the same Python object from the client's bounded cache. */
+static PyObject *
+LDAPClient_SetValueInterning(LDAPClient *self, PyObject *args) {
+	int enabled = 1, flags;
+	char *attr = NULL;
+	char name[128];
+
+	if (!PyArg_ParseTuple(args, "s|p", &attr, &enabled)) return NULL;
+
+	if (policy_key(attr, strlen(attr), name, sizeof(name)) <= 0) {
+		PyErr_SetString(PyExc_ValueError, "Invalid attribute name.");
+		return NULL;
+	}
+	flags = stored_flags(self, name);
+	if (enabled) flags |= _LDAP_DECODE_INTERN;
+	else flags &= ~_LDAP_DECODE_INTERN;
+	if (store_flags(self, name, flags) != 0) return NULL;
+	Py_RETURN_NONE;
+}
+
+/*	Returns the statistics of the interned values' cache. */
+static PyObject *
+LDAPClient_GetInterningStats(LDAPClient *self) {
+	return ValueCache_Stats(&self->valuecache);
+}
+
+/*	Releases the interned values, and resets the statistics. */
+static PyObject *
+LDAPClient_ClearInterningCache(LDAPClient *self) {
+	ValueCache_Clear(&self->valuecache);
+	Py_RETURN_NONE;
+}
+
+/*	Sends a search request without waiting for the response. Returns the message id. */
+static PyObject *
+LDAPClient_SendSearch(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int rc, msgid = -1;
+	int scope = -1;
+	int timeout = 0, sizelimit = 0, attrsonly = 0, page_size = 0, flags = 0;
+	char *basestr = NULL;
+	char *filterstr = NULL;
+	char **attrs = NULL;
+	PyObject *key, *flagsobj;
+	struct timeval timelimit;
+	struct timeval *timelimitp = NULL;
+
+	if (parse_search_args(self, args, nargs, kwnames, &basestr, &scope, &filterstr, &attrs,
+			&attrsonly, &timeout, &sizelimit, &page_size, &flags) != 0) {
+		return NULL;
+	}
+	if (page_size != 0) {
+		free_string_list(attrs);
+		PyErr_SetString(PyExc_ValueError, "Paged search is not supported by send_search.");
+		return NULL;
+	}
+	if (timeout > 0) {
+		timelimit.tv_sec = timeout;
+		timelimit.tv_usec = 0;
+		timelimitp = &timelimit;
+	}
+	if (filterstr != NULL && strlen(filterstr) == 0) filterstr = NULL;
+
+	LDAPCLIENT_BEGIN_CALL(self, { free_string_list(attrs); return NULL; })
+	rc = ldap_search_ext(self->ld, basestr, scope, filterstr, attrs, attrsonly, NULL, NULL,
+			timelimitp, sizelimit, &msgid);
+	LDAPCLIENT_END_CALL(self)
+	free_string_list(attrs);
+	key = LDAPClient_SetMsgId(self, rc, msgid);
+	if (key == NULL || flags == 0) return key;
+	/* Remember the flags of the entries for converting the result. */
+	flagsobj = PyLong_FromLong((long)flags);
+	if (flagsobj == NULL || PyDict_SetItem(self->search_flags, key, flagsobj) != 0) {
+		Py_XDECREF(flagsobj);
+		Py_DECREF(key);
+		return NULL;
+	}
+	Py_DECREF(flagsobj);
+	return key;
+}
+
+/*	Sends a delete request without waiting for the response. Returns the message id. */
+static PyObject *
+LDAPClient_SendDelete(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs) {
+	int rc, msgid = -1;
+	char *dnstr = NULL;
+	PyObject *values[1];
+	static char *kwlist[] = {"dn", NULL};
+
+	if (unpack_args("send_delete", args, nargs, NULL, kwlist, 1, values) != 0
+			|| arg2string(values[0], 0, &dnstr) != 0) return NULL;
+
+	if (!self->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+
+	LDAPCLIENT_BEGIN_CALL(self, return NULL)
+	rc = ldap_delete_ext(self->ld, dnstr, NULL, NULL, &msgid);
+	LDAPCLIENT_END_CALL(self)
+	return LDAPClient_SetMsgId(self, rc, msgid);
+}
+
+/*	Sends a compare request without waiting for the response. Returns the message id. */
+static PyObject *
+LDAPClient_SendCompare(LDAPClient *self, PyObject *const *args, Py_ssize_t nargs) {
+	int rc, msgid = -1;
+	char *dnstr = NULL;
+	char *attrstr = NULL;
+	char *tofree = NULL;
+	struct berval *bval;
+	PyObject *value;
+	PyObject *values[3];
+	static char *kwlist[] = {"dn", "attr", "value", NULL};
+
+	if (unpack_args("send_compare", args, nargs, NULL, kwlist, 3, values) != 0
+			|| arg2string(values[0], 0, &dnstr) != 0
+			|| arg2string(values[1], 0, &attrstr) != 0) return NULL;
+	value = values[2];
+
+	if (!self->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+
+	/* The value is borrowed from the `value` object, that is kept alive by the caller. */
+	bval = createBerval(value, &tofree);
+	if (bval == NULL) return NULL;
+
+	LDAPCLIENT_BEGIN_CALL(self, { free(tofree); free(bval); return NULL; })
+	rc = ldap_compare_ext(self->ld, dnstr, attrstr, bval, NULL, NULL, &msgid);
+	LDAPCLIENT_END_CALL(self)
+	free(tofree);
+	free(bval);
+	return LDAPClient_SetMsgId(self, rc, msgid);
+}
+
+/*	Sends a Who Am I request without waiting for the response. Returns the message id. */
+static PyObject *
+LDAPClient_SendWhoami(LDAPClient *self) {
+	int rc, msgid = -1;
+
+	if (!self->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+
+	LDAPCLIENT_BEGIN_CALL(self, return NULL)
+	rc = ldap_extended_operation(self->ld, "1.3.6.1.4.1.4203.1.11.3", NULL, NULL, NULL, &msgid);
+	LDAPCLIENT_END_CALL(self)
+	return LDAPClient_SetMsgId(self, rc, msgid);
 }
 
 static PyMemberDef LDAPClient_members[] = {
@@ -432,6 +1417,12 @@ static PyMemberDef LDAPClient_members[] = {
     {NULL}  /* Sentinel */
 };
 
+static PyGetSetDef LDAPClient_getsetters[] = {
+	{"pending", (getter)LDAPClient_getPending, NULL,
+	 "Message ids of the pending asynchronous operations.", NULL},
+	{NULL}  /* Sentinel */
+};
+
 static PyMethodDef LDAPClient_methods[] = {
 	{"close", (PyCFunction)LDAPClient_Close, METH_NOARGS,
 	 "Close connection with the LDAP Server."
@@ -439,21 +1430,70 @@ static PyMethodDef LDAPClient_methods[] = {
 	{"connect", (PyCFunction)LDAPClient_Connect,  METH_VARARGS | METH_KEYWORDS,
 	 "Open a connection to the LDAP Server."
 	},
-	{"del_entry", (PyCFunction)LDAPClient_DelEntry, METH_VARARGS,
+	{"del_entry", (PyCFunction)LDAPClient_DelEntry, METH_FASTCALL | METH_KEYWORDS,
 	"Delete an LDAPEntry with the given distinguished name."
 	},
-	{"get_entry", (PyCFunction)LDAPClient_GetEntry, METH_VARARGS | METH_KEYWORDS,
+	{"get_entry", (PyCFunction)LDAPClient_GetEntry, METH_FASTCALL | METH_KEYWORDS,
 	"Return an LDAPEntry with the given distinguished name, or return None if the entry doesn't exist."
 	},
+	{"iter_values", (PyCFunction)LDAPClient_IterValues, METH_FASTCALL | METH_KEYWORDS,
+	"Return an iterator over the values of an entry's attribute, which are retrieved range by range."
+	},
+	{"get_decode_policy", (PyCFunction)LDAPClient_GetDecodePolicy, METH_FASTCALL,
+	"Return the decoding policy of an attribute's values ('auto', 'bytes' or 'str')."
+	},
+	{"get_interning_stats", (PyCFunction)LDAPClient_GetInterningStats, METH_NOARGS,
+	"Return the statistics of the interned values: the number of the cached values, the hits, "
+	"the misses and the saved memory in bytes."
+	},
 	{"get_rootDSE", (PyCFunction)LDAPClient_GetRootDSE, METH_NOARGS,
 	"Return an LDAPEntry of the RootDSE."
 	},
-	{"search", (PyCFunction)LDAPClient_Search, METH_VARARGS | METH_KEYWORDS,
+	{"clear_interning_cache", (PyCFunction)LDAPClient_ClearInterningCache, METH_NOARGS,
+	"Release the interned values and reset their statistics."
+	},
+	{"modify_values", (PyCFunction)LDAPClient_ModifyValues, METH_FASTCALL | METH_KEYWORDS,
+	"Add and remove values of an entry's attribute with one modify request, without getting the entry."
+	},
+	{"search", (PyCFunction)LDAPClient_Search, METH_FASTCALL | METH_KEYWORDS,
 	 "Searches for LDAP entries."
 	},
+	{"search_iter", (PyCFunction)LDAPClient_SearchIter, METH_FASTCALL | METH_KEYWORDS,
+	 "Searches for LDAP entries with paged results (or streaming, if page_size is 0), returns an iterator."
+	},
 	{"whoami", (PyCFunction)LDAPClient_Whoami, METH_NOARGS,
 	 "LDAPv3 Who Am I operation."
 	},
+	{"fileno", (PyCFunction)LDAPClient_Fileno, METH_NOARGS,
+	 "Return the socket descriptor of the connection."
+	},
+	{"poll", (PyCFunction)LDAPClient_Poll, METH_FASTCALL,
+	 "Check, without blocking, that the response of an asynchronous operation is arrived. "
+	 "Without message id, collect every arrived response and return their message ids."
+	},
+	{"result", (PyCFunction)LDAPClient_Result, METH_FASTCALL,
+	 "Return the result of an asynchronous operation, wait for it if it is necessary."
+	},
+	{"send_compare", (PyCFunction)LDAPClient_SendCompare, METH_FASTCALL,
+	 "Send an LDAP compare request, return the message id."
+	},
+	{"send_delete", (PyCFunction)LDAPClient_SendDelete, METH_FASTCALL,
+	 "Send an LDAP delete request, return the message id."
+	},
+	{"send_search", (PyCFunction)LDAPClient_SendSearch, METH_FASTCALL | METH_KEYWORDS,
+	 "Send an LDAP search request, return the message id."
+	},
+	{"set_decode_policy", (PyCFunction)LDAPClient_SetDecodePolicy, METH_VARARGS,
+	 "Set the decoding policy of an attribute's values: 'auto' (string if it is valid UTF-8, "
+	 "bytes otherwise), 'bytes' or 'str'."
+	},
+	{"set_value_interning", (PyCFunction)LDAPClient_SetValueInterning, METH_VARARGS,
+	 "Enable (or disable with False) the interning of an attribute's values: the repeated "
+	 "values share one Python object."
+	},
+	{"send_whoami", (PyCFunction)LDAPClient_SendWhoami, METH_NOARGS,
+	 "Send an LDAPv3 Who Am I request, return the message id."
+	},
     {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
@@ -478,17 +1518,18 @@ PyTypeObject LDAPClientType = {
     0,                         /* tp_setattro */
     0,                         /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT |
-        Py_TPFLAGS_BASETYPE,   /* tp_flags */
+        Py_TPFLAGS_BASETYPE |
+        Py_TPFLAGS_HAVE_GC,    /* tp_flags */
     "LDAPClient object",   	   /* tp_doc */
-    0,                         /* tp_traverse */
-    0,                         /* tp_clear */
+    (traverseproc)LDAPClient_traverse, /* tp_traverse */
+    (inquiry)LDAPClient_clear, /* tp_clear */
     0,                         /* tp_richcompare */
     0,                         /* tp_weaklistoffset */
     0,                         /* tp_iter */
     0,                         /* tp_iternext */
     LDAPClient_methods,        /* tp_methods */
     LDAPClient_members,        /* tp_members */
-    0,                         /* tp_getset */
+    LDAPClient_getsetters,     /* tp_getset */
     0,                         /* tp_base */
     0,                         /* tp_dict */
     0,                         /* tp_descr_get */
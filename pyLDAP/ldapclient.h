@@ -18,16 +18,37 @@
 
 #endif
 
+#include "valuecache.h"
+
 typedef struct {
 	PyObject_HEAD
 	PyObject *url;
 	LDAP *ld;
 	int connected;
 	int tls;
+	int busy;
+	PyObject *results;
+	PyObject *pending;
+	PyObject *search_flags;
+	PyObject *decode_policies;
+	ValueCache valuecache;
 } LDAPClient;
 
+/*	Release the GIL around a blocking libldap call of the `client`. The running calls are
+	counted (with the GIL held), so close() does not free the handle under another thread.
+	If the client has been closed meanwhile (e.g. by another thread, while Python code of
+	the caller was running), NotConnected is set and the `onerror` statement is executed. */
+#define LDAPCLIENT_BEGIN_CALL(client, onerror) \
+	if (LDAPClient_BeginCall(client) != 0) onerror; \
+	Py_BEGIN_ALLOW_THREADS
+#define LDAPCLIENT_END_CALL(client) Py_END_ALLOW_THREADS (client)->busy--;
+
 extern PyTypeObject LDAPClientType;
 
+int LDAPClient_BeginCall(LDAPClient *self);
 int LDAPClient_DelEntryStringDN(LDAPClient *self, char *dnstr);
+PyObject *LDAPClient_SetMsgId(LDAPClient *self, int rc, int msgid);
+int LDAPClient_DecodePolicy(LDAPClient *self, const char *attr, Py_ssize_t len);
+PyObject *LDAPClient_DecodeValue(LDAPClient *self, struct berval *bval, int policy);
 
 #endif /* LDAPCLIENT_H_ */
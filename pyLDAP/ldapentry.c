@@ -2,6 +2,25 @@
 #include "uniquelist.h"
 
 #include "ldapentry.h"
+#include "ldapfrozenentry.h"
+#include "ldapvalueiter.h"
+
+static int LDAPEntry_setDN(LDAPEntry *self, PyObject *value, void *closure);
+
+/*	Releases the not decoded attributes of a lazy LDAPEntry, and the message they belong to. */
+static void
+release_lazy(LDAPEntry *self) {
+	Py_ssize_t i;
+
+	for (i = 0; i < self->nlazy; i++) {
+		Py_DECREF(self->lazyattrs[i].name);
+		ldap_memfree(self->lazyattrs[i].values);
+	}
+	free(self->lazyattrs);
+	self->lazyattrs = NULL;
+	self->nlazy = 0;
+	Py_CLEAR(self->msgowner);
+}
 
 static int
 LDAPEntry_clear(LDAPEntry *self) {
@@ -22,6 +41,8 @@ LDAPEntry_clear(LDAPEntry *self) {
     tmp = self->dn;
     self->dn = NULL;
     Py_XDECREF(tmp);
+    CaseIndex_Clear(&self->keyindex);
+    release_lazy(self);
     PyDict_Type.tp_clear((PyObject*)self);
 
     return 0;
@@ -37,11 +58,32 @@ LDAPEntry_dealloc(LDAPEntry* self) {;
 static int
 LDAPEntry_traverse(LDAPEntry *self, visitproc visit, void *arg) {
 	Py_VISIT(self->dn);
+	Py_VISIT(self->client);
     Py_VISIT(self->deleted);
 	Py_VISIT(self->attributes);
+	Py_VISIT(self->msgowner);
     return 0;
 }
 
+/* The recycled memory of the deallocated LDAPEntries. */
+static LDAPFreeList freelist;
+
+static PyObject *
+LDAPEntry_alloc(PyTypeObject *type, Py_ssize_t nitems) {
+	return freelist_alloc(&freelist, type, nitems);
+}
+
+static void
+LDAPEntry_free(void *self) {
+	freelist_free(&freelist, self);
+}
+
+/*	Releases the recycled memory of the LDAPEntries. */
+void
+LDAPEntry_ClearFreeList(void) {
+	freelist_clear(&freelist);
+}
+
 /*	Create a new LDAPEntry object. */
 static PyObject *
 LDAPEntry_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
@@ -68,6 +110,9 @@ LDAPEntry_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
 			return NULL;
 		}
         self->client = NULL;
+        self->msgowner = NULL;
+        self->lazyattrs = NULL;
+        self->nlazy = 0;
 	}
     return (PyObject *)self;
 }
@@ -118,102 +163,168 @@ LDAPEntry_Check(PyObject *obj) {
 
 /*	Returns a NULL-delimitered LDAPMod list for adds new or modificates existing LDAP entries.
 	It uses only those LDAPValueList, whose status is 1 - add or delete, or 2 - replace, and
-	the deleted keys listed in LDAPEntry's deleted list.
+	the deleted keys listed in LDAPEntry's deleted list. The list is allocated in the `arena`.
 */
 LDAPMod **
-LDAPEntry_CreateLDAPMods(LDAPEntry *self) {
-	int i = 0;
-	Py_ssize_t j;
-	LDAPMod *mod;
+LDAPEntry_CreateLDAPMods(LDAPEntry *self, LDAPArena *arena) {
+	int rc;
+	Py_ssize_t i = 0, j;
+	LDAPMod *mod = NULL;
 	LDAPMod **mods;
-	PyObject *keys = PyMapping_Keys((PyObject *)self);
-	PyObject *iter, *key;
+	/* The not decoded attributes of a lazy entry are unchanged, only the dict's keys are needed. */
+	PyObject *keys = PyDict_Keys((PyObject *)self);
+	PyObject *key;
 	LDAPValueList *value;
-
-	mods = (LDAPMod **)malloc(sizeof(LDAPMod *) * (Py_SIZE(self)*2 + 1));
-	if (mods == NULL) return NULL;
+	UniqueList *deleted;
 
 	if (keys == NULL) return NULL;
 
-	iter = PyObject_GetIter(keys);
+	mods = (LDAPMod **)arena_alloc(arena, sizeof(LDAPMod *)
+			* (PyList_GET_SIZE(keys) * 2 + Py_SIZE(self->deleted) + 1));
+	if (mods == NULL || arena_keep(arena, keys) != 0) {
+		Py_DECREF(keys);
+		return NULL;
+	}
 	Py_DECREF(keys);
-	if (iter == NULL) return NULL;
 
-	for (key = PyIter_Next(iter); key != NULL; key = PyIter_Next(iter)) {
-		/* Return value: New reference. */
+	for (j = 0; j < PyList_GET_SIZE(keys); j++) {
+		key = PyList_GET_ITEM(keys, j);
 		value = (LDAPValueList *)LDAPEntry_GetItem(self, key);
-		if (value == NULL) {
-			Py_DECREF(iter);
-			Py_DECREF(key);
-			return NULL;
-		}
+		if (value == NULL) return NULL;
 		if (value->status == 1) {
 			/* LDAPMod for newly added attributes and values. */
 			if (Py_SIZE((PyObject *)value->added) > 0) {
-				mod = createLDAPModFromItem(LDAP_MOD_ADD | LDAP_MOD_BVALUES, key, (PyObject *)value->added);
+				mod = createLDAPModFromItem(arena, LDAP_MOD_ADD | LDAP_MOD_BVALUES, key, (PyObject *)value->added);
 				if (mod == NULL) return NULL;
 				mods[i++] = mod;
 			}
 			/* LDAPMod for deleted values. */
 			if (Py_SIZE((PyObject *)value->deleted) > 0) {
-				mod = createLDAPModFromItem(LDAP_MOD_DELETE | LDAP_MOD_BVALUES, key, (PyObject *)value->deleted);
+				mod = createLDAPModFromItem(arena, LDAP_MOD_DELETE | LDAP_MOD_BVALUES, key, (PyObject *)value->deleted);
 				if (mod == NULL) return NULL;
 				mods[i++] = mod;
 			}
 		} else if (value->status == 2) {
 			/* LDAPMod for replaced attributes. */
-			mod = createLDAPModFromItem(LDAP_MOD_REPLACE | LDAP_MOD_BVALUES, key, (PyObject *)value);
+			mod = createLDAPModFromItem(arena, LDAP_MOD_REPLACE | LDAP_MOD_BVALUES, key, (PyObject *)value);
 			if (mod == NULL) return NULL;
 			mods[i++] = mod;
 		}
-		Py_DECREF(key);
 	}
-	Py_DECREF(iter);
 	/* LDAPMod for deleted attributes. */
 	for (j = 0; j < Py_SIZE((PyObject *)self->deleted); j++) {
-		mod = createLDAPModFromItem(LDAP_MOD_DELETE | LDAP_MOD_BVALUES, self->deleted->list.ob_item[j], NULL);
-		Py_DECREF(self->deleted->list.ob_item[j]);
+		mod = createLDAPModFromItem(arena, LDAP_MOD_DELETE | LDAP_MOD_BVALUES, self->deleted->list.ob_item[j], NULL);
 		if (mod == NULL) return NULL;
 		mods[i++] = mod;
 	}
+	/* The arena keeps the old list of the deleted keys. */
+	deleted = UniqueList_New();
+	if (deleted == NULL) return NULL;
+	rc = arena_keep(arena, (PyObject *)self->deleted);
+	if (rc != 0) {
+		Py_DECREF(deleted);
+		return NULL;
+	}
 	Py_DECREF(self->deleted);
-	self->deleted = UniqueList_New();
+	self->deleted = deleted;
 	mods[i] = NULL;
 	return mods;
 }
 
-/* Frees null-delimitered LDAPMod list. */
+/*	Changes the status of the attributes of a sent LDAPMod list to "not changed", and
+	forgets the sent changes. The memory of the list is released with its arena. */
 void
 LDAPEntry_DismissLDAPMods(LDAPEntry *self, LDAPMod **mods) {
-	int i, j;
-	struct berval **bvals;
+	int i;
 	LDAPValueList *val;
 
 	for (i = 0; mods[i] != NULL; i++) {
-		bvals = mods[i]->mod_vals.modv_bvals;
-		if (bvals != NULL) {
-			for (j = 0; bvals[j] != NULL; j++) {
-				free(bvals[j]->bv_val);
-				free(bvals[j]);
-			}
-		}
-		/* Change attributes' status to "not changed" (-1). */
 		val = (LDAPValueList *)LDAPEntry_GetItemString(self, mods[i]->mod_type);
-		if (val != NULL) val->status = -1;
-		free(mods[i]->mod_type);
-		free(mods[i]);
+		if (val != NULL) {
+			val->status = -1;
+			UniqueList_SetSlice(val->added, 0, Py_SIZE(val->added), NULL);
+			UniqueList_SetSlice(val->deleted, 0, Py_SIZE(val->deleted), NULL);
+		}
+	}
+}
+
+/*	Appends a received `val` to the `lvl` list without marking it as a change. */
+static int
+append_item(LDAPValueList *lvl, PyObject *val) {
+	int rc = UniqueList_Append((UniqueList *)lvl, val);
+
+	if (rc != 0 && PyErr_ExceptionMatches(PyExc_ValueError)) {
+		/* Values of case-sensitive attributes may differ only in case,
+		   keep them, but only the first one is indexed. */
+		PyErr_Clear();
+		rc = PyList_Append((PyObject *)lvl, val);
 	}
+	return rc;
 }
 
-/*	Create a LDAPEntry from a LDAPMessage. */
+/*	Appends the `bval` value converted by the `policy` of the `client` to the `lvl` list. */
+static int
+append_value(LDAPClient *client, LDAPValueList *lvl, struct berval *bval, int policy) {
+	int rc;
+	PyObject *val = LDAPClient_DecodeValue(client, bval, policy);
+
+	if (val == NULL) return -1;
+	rc = append_item(lvl, val);
+	Py_DECREF(val);
+	return rc;
+}
+
+/*	Adds the `attrobj` attribute with the `lvl` values to a new LDAPEntry. Without
+	values (e.g. attrsonly search), only the attribute list is extended. */
+static int
+add_attribute(LDAPEntry *self, PyObject *attrobj, LDAPValueList *lvl) {
+	if (UniqueList_Append(self->attributes, attrobj) != 0) return -1;
+	if (lvl == NULL) return 0;
+	if (PyDict_SetItem((PyObject *)self, attrobj, (PyObject *)lvl) != 0) return -1;
+	return CaseIndex_Insert(&self->keyindex, attrobj);
+}
+
+/*	Adds the `attrobj` attribute with the items of the `values` sequence to the LDAPEntry
+	as they were received from the server, so they are not sent as changes. An empty
+	sequence adds only the attribute's name (like an attrsonly search).
+	Returns 0 on success, -1 otherwise. */
+int
+LDAPEntry_AddReceived(LDAPEntry *self, PyObject *attrobj, PyObject *values) {
+	int rc = 0;
+	Py_ssize_t i;
+	PyObject *seq;
+	LDAPValueList *lvl = NULL;
+
+	seq = PySequence_Fast(values, "The values must be a sequence.");
+	if (seq == NULL) return -1;
+	if (PySequence_Fast_GET_SIZE(seq) > 0) {
+		lvl = LDAPValueList_New();
+		if (lvl == NULL) rc = -1;
+		for (i = 0; rc == 0 && i < PySequence_Fast_GET_SIZE(seq); i++) {
+			rc = append_item(lvl, PySequence_Fast_GET_ITEM(seq, i));
+		}
+	}
+	Py_DECREF(seq);
+	if (rc == 0) rc = add_attribute(self, attrobj, lvl);
+	Py_XDECREF(lvl);
+	return rc;
+}
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+/*	Create a LDAPEntry from a LDAPMessage. The lazy decoding needs ldap_get_attribute_ber,
+	so the `msgowner` is not used, the values are always decoded. The attributes' names
+	are taken from the `layout` of the result (if it's not NULL). */
 LDAPEntry *
-LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client) {
-	int i;
+LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client, PyObject *msgowner,
+		AttrLayout *layout) {
+	int i, policy;
+	Py_ssize_t pos = 0;
 	char *dn;
-	char *attr;
-	struct berval **values;
-	BerElement *ber;
-	PyObject *val, *attrobj;
+	char *attr = NULL;
+	struct berval **values = NULL;
+	BerElement *ber = NULL;
+	PyObject *attrobj = NULL;
 	LDAPValueList *lvl = NULL;
 	LDAPEntry *self;
 
@@ -227,9 +338,8 @@ LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client) {
 	dn = ldap_get_dn(client->ld, entrymsg);
 	if (dn != NULL) {
 		if (LDAPEntry_SetStringDN(self, dn) != 0) {
-			Py_DECREF(self);
 			ldap_memfree(dn);
-			return NULL;
+			goto Fail;
 		}
 		ldap_memfree(dn);
 	}
@@ -237,94 +347,400 @@ LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client) {
 	/* Iterate over the LDAP attributes. */
 	for (attr = ldap_first_attribute(client->ld, entrymsg, &ber);
 		attr != NULL; attr = ldap_next_attribute(client->ld, entrymsg, ber)) {
-		/* Create a string of attribute's name and add to the attributes list. */
-		attrobj = PyUnicode_FromString(attr);
-		if (attrobj == NULL || UniqueList_Append(self->attributes, attrobj) !=  0) {
-			Py_DECREF(self);
-			Py_XDECREF(attrobj);
-			ldap_memfree(attr);
-			if (ber != NULL) {
-				ber_free(ber, 0);
-			}
-			return (LDAPEntry *)PyErr_NoMemory();
-		}
+		/* Get the string of attribute's name. */
+		attrobj = AttrLayout_GetName(layout, pos++, attr, strlen(attr));
+		if (attrobj == NULL) goto Fail;
 		values = ldap_get_values_len(client->ld, entrymsg, attr);
 		if (values != NULL) {
 			lvl = LDAPValueList_New();
-			if (lvl == NULL){
-				Py_DECREF(self);
-				Py_DECREF(attrobj);
-				ldap_memfree(attr);
-				if (ber != NULL) {
-					ber_free(ber, 0);
-				}
-				return (LDAPEntry *)PyErr_NoMemory();
+			if (lvl == NULL) goto Fail;
+			policy = LDAPClient_DecodePolicy(client, attr, strlen(attr));
+			for (i = 0; values[i] != NULL; i++) {
+				if (append_value(client, lvl, values[i], policy) != 0) goto Fail;
 			}
+			ldap_value_free_len(values);
+			values = NULL;
+		}
+		if (add_attribute(self, attrobj, lvl) != 0) goto Fail;
+		Py_CLEAR(attrobj);
+		Py_CLEAR(lvl);
+		ldap_memfree(attr);
+	}
+	if (ber != NULL) ber_free(ber, 0);
+	return self;
 
-			for (i = 0; values[i] != NULL; i++) {
-				/* Convert berval to PyObject*, if it's failed skip it. */
-				val = berval2PyObject(values[i]);
-				if (val == NULL) continue;
-				/* If the attribute has more value, then append to the list. */
-				if (PyList_Append((PyObject *)lvl, val) != 0) {
-					Py_DECREF(lvl);
-					Py_DECREF(self);
-					Py_DECREF(attrobj);
-					ldap_memfree(attr);
-					if (ber != NULL) {
-						ber_free(ber, 0);
-					}
-					return (LDAPEntry *)PyErr_NoMemory();
-				}
+Fail:
+	Py_XDECREF(attrobj);
+	Py_XDECREF(lvl);
+	Py_DECREF(self);
+	if (values != NULL) ldap_value_free_len(values);
+	if (attr != NULL) ldap_memfree(attr);
+	if (ber != NULL) ber_free(ber, 0);
+	return NULL;
+}
+
+#else
+
+/*	Keeps the borrowed `values` of the `attrobj` attribute in a lazy LDAPEntry to decode
+	them later. The `size` is the allocated length of the entry's lazyattrs array.
+	Returns 0 on success, -1 otherwise. */
+static int
+add_lazy_attribute(LDAPEntry *self, PyObject *attrobj, struct berval *values, Py_ssize_t *size) {
+	LDAPLazyAttr *tmp;
+
+	if (self->nlazy == *size) {
+		*size = (*size == 0) ? 16 : *size * 2;
+		tmp = (LDAPLazyAttr *)realloc(self->lazyattrs, sizeof(LDAPLazyAttr) * (*size));
+		if (tmp == NULL) {
+			PyErr_NoMemory();
+			return -1;
+		}
+		self->lazyattrs = tmp;
+	}
+	if (UniqueList_Append(self->attributes, attrobj) != 0) return -1;
+	if (CaseIndex_Insert(&self->keyindex, attrobj) != 0) return -1;
+	Py_INCREF(attrobj);
+	self->lazyattrs[self->nlazy].name = attrobj;
+	self->lazyattrs[self->nlazy].values = values;
+	self->nlazy++;
+	return 0;
+}
+
+/*	Create a LDAPEntry from a LDAPMessage. The DN, the attributes' names and values
+	are decoded in place from the message's BER buffer (nothing is copied by libldap),
+	so every value is copied once, directly into its Python object.
+	If `msgowner` is not NULL, the LDAPEntry is lazy: only the attributes' names are
+	decoded, the values are left in the message (which is kept alive by the `msgowner`),
+	and they are converted to Python objects on their first access.
+	The attributes' names are taken from the `layout` of the result (if it's not NULL).
+*/
+LDAPEntry *
+LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client, PyObject *msgowner,
+		AttrLayout *layout) {
+	int i, rc, policy;
+	Py_ssize_t pos = 0, size = 0;
+	struct berval dn, attr;
+	struct berval *values = NULL;
+	BerElement *ber = NULL;
+	PyObject *dnobj, *attrobj = NULL;
+	LDAPValueList *lvl = NULL;
+	LDAPEntry *self;
+
+	/* Create a new LDAPEntry, raise PyErr_NoMemory if it's failed. */
+	self = LDAPEntry_New();
+	if (self == NULL) {
+		return (LDAPEntry *)PyErr_NoMemory();
+	}
+	LDAPEntry_SetClient(self, client);
+	/* Set the DN for LDAPEntry. */
+	rc = ldap_get_dn_ber(client->ld, entrymsg, &ber, &dn);
+	if (rc != LDAP_SUCCESS) goto Error;
+	if (dn.bv_val != NULL) {
+		dnobj = PyUnicode_DecodeUTF8(dn.bv_val, dn.bv_len, NULL);
+		if (dnobj == NULL) goto Fail;
+		rc = LDAPEntry_setDN(self, dnobj, NULL);
+		Py_DECREF(dnobj);
+		if (rc != 0) goto Fail;
+	}
+
+	/* Iterate over the LDAP attributes, `values` is an array of borrowed bervals. */
+	for (rc = ldap_get_attribute_ber(client->ld, entrymsg, ber, &attr, &values);
+		rc == LDAP_SUCCESS && attr.bv_val != NULL;
+		rc = ldap_get_attribute_ber(client->ld, entrymsg, ber, &attr, &values)) {
+		/* Get the string of attribute's name. */
+		attrobj = AttrLayout_GetName(layout, pos++, attr.bv_val, attr.bv_len);
+		if (attrobj == NULL) goto Fail;
+		if (msgowner != NULL && values != NULL) {
+			if (add_lazy_attribute(self, attrobj, values, &size) != 0) goto Fail;
+			values = NULL;
+			Py_CLEAR(attrobj);
+			continue;
+		}
+		if (values != NULL) {
+			lvl = LDAPValueList_New();
+			if (lvl == NULL) goto Fail;
+			policy = LDAPClient_DecodePolicy(client, attr.bv_val, attr.bv_len);
+			for (i = 0; values[i].bv_val != NULL; i++) {
+				if (append_value(client, lvl, &values[i], policy) != 0) goto Fail;
 			}
-			PyDict_SetItem((PyObject *)self, attrobj, (PyObject *)lvl);
+			ber_memfree(values);
+			values = NULL;
 		}
-		ldap_value_free_len(values);
+		if (add_attribute(self, attrobj, lvl) != 0) goto Fail;
+		Py_CLEAR(attrobj);
+		Py_CLEAR(lvl);
 	}
-	/* Cleaning the mess. */
-	ldap_memfree(attr);
-	if (ber != NULL) {
-		ber_free(ber, 0);
+	if (rc != LDAP_SUCCESS) goto Error;
+	ber_free(ber, 0);
+	if (self->nlazy > 0) {
+		Py_INCREF(msgowner);
+		self->msgowner = msgowner;
 	}
 	return self;
+
+Error:
+	{
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+	}
+Fail:
+	Py_XDECREF(attrobj);
+	Py_XDECREF(lvl);
+	Py_DECREF(self);
+	if (values != NULL) ber_memfree(values);
+	if (ber != NULL) ber_free(ber, 0);
+	return NULL;
+}
+
+#endif
+
+/*	Untracks the lists of the DN object (the parsed RDNs) by the garbage collector. */
+static int
+untrack_dn_visit(PyObject *obj, void *arg) {
+	if (PyList_CheckExact(obj)) PyObject_GC_UnTrack(obj);
+	return 0;
+}
+
+/*	Untracks a received LDAPEntry and its containers by the garbage collector.
+	They contain only strings and bytes, so they cannot be a part of a cycle. The dict
+	and the lists are tracked again, when a trackable object is added to them. */
+static void
+untrack_entry(LDAPEntry *self) {
+	Py_ssize_t pos = 0;
+	PyObject *key, *value;
+	PyObject *ldapdn_type = get_ldapdn_type();
+
+	while (PyDict_Next((PyObject *)self, &pos, &key, &value)) {
+		if (Py_TYPE(value) == &LDAPValueListType) LDAPValueList_UnTrack((LDAPValueList *)value);
+	}
+	PyObject_GC_UnTrack(self->attributes);
+	PyObject_GC_UnTrack(self->deleted);
+	if (ldapdn_type == NULL) {
+		PyErr_Clear();
+	} else if (Py_TYPE(self->dn) == (PyTypeObject *)ldapdn_type) {
+		Py_TYPE(self->dn)->tp_traverse(self->dn, untrack_dn_visit, NULL);
+		PyObject_GC_UnTrack(self->dn);
+	}
+	PyObject_GC_UnTrack(self);
+}
+
+/*	Creates an entry of a search result: an LDAPFrozenEntry with the _LDAP_ENTRY_FROZEN
+	`flags`, an LDAPEntry otherwise (a lazy one, if `msgowner` is set). The entries of
+	the same result share the attributes' names of the `layout`. With the
+	_LDAP_ENTRY_UNTRACKED flag the entry is not tracked by the garbage collector.
+	Returns Py_None for an entry without any attribute, which is skipped by the callers. */
+PyObject *
+LDAPEntry_Create(LDAPMessage *entrymsg, LDAPClient *client, int flags, PyObject *msgowner,
+		AttrLayout *layout) {
+	Py_ssize_t size;
+	PyObject *entryobj;
+
+	if (flags & _LDAP_ENTRY_FROZEN) {
+		entryobj = (PyObject *)LDAPFrozenEntry_FromLDAPMessage(entrymsg, client, layout);
+		if (entryobj == NULL) return NULL;
+		size = PyDict_Size(entryobj);
+	} else {
+		entryobj = (PyObject *)LDAPEntry_FromLDAPMessage(entrymsg, client, msgowner, layout);
+		if (entryobj == NULL) return NULL;
+		size = PyList_GET_SIZE(((LDAPEntry *)entryobj)->attributes);
+	}
+	if (size == 0) {
+		Py_DECREF(entryobj);
+		Py_RETURN_NONE;
+	}
+	if (flags & _LDAP_ENTRY_UNTRACKED) {
+		if (flags & _LDAP_ENTRY_FROZEN) {
+			LDAPFrozenEntry_UnTrack((LDAPFrozenEntry *)entryobj);
+		} else {
+			untrack_entry((LDAPEntry *)entryobj);
+		}
+	}
+	return entryobj;
+}
+
+/*	Moves the values of the attributes, which are received in a range (e.g. "member;range=0-1499"
+	instead of "member"), to the plain name of the attribute. For every incomplete range an
+	LDAPValueIter is started, and appended to the `iters` list with the LDAPValueList, which
+	the rest of the values belong to. Returns 0 on success, -1 otherwise. */
+static int
+collect_ranges(LDAPEntry *self, LDAPClient *client, PyObject *iters) {
+	int rc = -1;
+	Py_ssize_t i, len, prefix, next;
+	const char *attr;
+	PyObject *key, *name = NULL, *dn = NULL, *item;
+	LDAPValueList *lvl, *match;
+	LDAPValueIter *iter;
+
+	/* The attribute with the plain name is appended to the end, so it is not checked again. */
+	for (i = PyList_GET_SIZE(self->attributes) - 1; i >= 0; i--) {
+		key = PyList_GET_ITEM(self->attributes, i);
+		attr = PyUnicode_AsUTF8AndSize(key, &len);
+		if (attr == NULL) goto Done;
+		if (memchr(attr, ';', len) == NULL) continue;
+		prefix = parse_attr_range(attr, len, &next);
+		if (prefix == -1) continue;
+
+		/* Decode the values of a lazy entry's attribute. */
+		Py_INCREF(key);
+		lvl = (LDAPValueList *)LDAPEntry_GetItem(self, key);
+		if (lvl == NULL && PyErr_Occurred()) goto Error;
+		Py_XINCREF(lvl);
+		if (lvl != NULL && PyDict_DelItem((PyObject *)self, key) != 0) goto Error;
+		if (CaseIndex_Remove(&self->keyindex, key) == -1) goto Error;
+		if (UniqueList_SetSlice(self->attributes, i, i + 1, NULL) != 0) goto Error;
+
+		name = PyUnicode_FromStringAndSize(attr, prefix);
+		if (name == NULL) goto Error;
+		match = (LDAPValueList *)LDAPEntry_GetItem(self, name);
+		if (match != NULL && lvl != NULL) {
+			/* The server sent the attribute in both forms. */
+			for (len = 0; len < PyList_GET_SIZE(lvl); len++) {
+				if (append_item(match, PyList_GET_ITEM(lvl, len)) != 0) goto Error;
+			}
+			Py_INCREF(match);
+			Py_DECREF(lvl);
+			lvl = match;
+		} else if (match == NULL) {
+			if (PyErr_Occurred() || add_attribute(self, name, lvl) != 0) goto Error;
+		}
+
+		if (lvl != NULL && next != -1) {
+			if (dn == NULL) {
+				dn = PyObject_Str(self->dn);
+				if (dn == NULL || PyUnicode_AsUTF8(dn) == NULL) goto Error;
+			}
+			iter = LDAPValueIter_New(client, PyUnicode_AsUTF8(dn), name, next);
+			if (iter == NULL) goto Error;
+			item = Py_BuildValue("(NO)", iter, lvl);
+			if (item == NULL || PyList_Append(iters, item) != 0) {
+				Py_XDECREF(item);
+				goto Error;
+			}
+			Py_DECREF(item);
+		}
+		Py_CLEAR(name);
+		Py_XDECREF(lvl);
+		Py_DECREF(key);
+	}
+	rc = 0;
+	goto Done;
+Error:
+	Py_XDECREF(name);
+	Py_XDECREF(lvl);
+	Py_DECREF(key);
+Done:
+	Py_XDECREF(dn);
+	return rc;
+}
+
+/*	Completes the attributes of the `entries` (a list of LDAPEntries or a single one), whose
+	values are retrieved in more ranges. The requests of every entry's attributes are sent at
+	once, and the next range of an attribute is requested as soon as the current one arrives,
+	so the number of round trips depends on the largest attribute, not on the number of them.
+	The values are added as they were received with the entry. Returns 0 on success, -1 otherwise. */
+int
+LDAPEntry_FetchRanges(LDAPClient *client, PyObject *entries) {
+	int rc = 0;
+	Py_ssize_t i, j;
+	PyObject *iters, *item, *values;
+	LDAPValueList *lvl;
+
+	iters = PyList_New(0);
+	if (iters == NULL) return -1;
+	if (LDAPEntry_Check(entries)) {
+		rc = collect_ranges((LDAPEntry *)entries, client, iters);
+	} else {
+		for (i = 0; rc == 0 && i < PyList_GET_SIZE(entries); i++) {
+			item = PyList_GET_ITEM(entries, i);
+			if (LDAPEntry_Check(item)) rc = collect_ranges((LDAPEntry *)item, client, iters);
+		}
+	}
+
+	/* Receive one range of every attribute in turn, so each of them has a running request. */
+	while (rc == 0 && PyList_GET_SIZE(iters) > 0) {
+		for (i = PyList_GET_SIZE(iters) - 1; rc == 0 && i >= 0; i--) {
+			item = PyList_GET_ITEM(iters, i);
+			lvl = (LDAPValueList *)PyTuple_GET_ITEM(item, 1);
+			values = LDAPValueIter_NextRange((LDAPValueIter *)PyTuple_GET_ITEM(item, 0));
+			if (values == NULL) {
+				if (PyErr_Occurred()) rc = -1;
+				else rc = PyList_SetSlice(iters, i, i + 1, NULL);
+				continue;
+			}
+			for (j = 0; rc == 0 && j < PyList_GET_SIZE(values); j++) {
+				rc = append_item(lvl, PyList_GET_ITEM(values, j));
+			}
+			Py_DECREF(values);
+		}
+	}
+	/* The still running requests are abandoned. */
+	Py_DECREF(iters);
+	return rc;
 }
 
-/* Preform a LDAP add or modify operation depend on the `mod` parameter. */
+/*	Preform a LDAP add or modify operation depend on the `mod` parameter.
+	If `msgid` is not NULL, the request is only sent, and its message id is returned.
+*/
 PyObject *
-add_or_modify(LDAPEntry *self, int mod) {
+add_or_modify(LDAPEntry *self, int mod, int *msgid) {
 	int rc = -1;
-	char *dnstr = NULL;
+	Py_ssize_t len;
+	const char *dnstr = NULL;
 	LDAPMod **mods = NULL;
+	PyObject *dn;
+	LDAPArena arena;
 
+	arena_init(&arena);
 	/* Get DN string. */
-	dnstr = PyObject2char(self->dn);
-	if (dnstr == NULL || strlen(dnstr) == 0) {
+	dn = PyObject_Str(self->dn);
+	if (dn == NULL) return NULL;
+	rc = arena_keep(&arena, dn);
+	Py_DECREF(dn);
+	if (rc == 0) dnstr = arena_buffer(&arena, dn, &len);
+	if (dnstr == NULL || len == 0) {
+		arena_free(&arena);
 		PyErr_SetString(PyExc_AttributeError, "Missing distinguished name.");
 		return NULL;
 	}
-	mods = LDAPEntry_CreateLDAPMods(self);
+	mods = LDAPEntry_CreateLDAPMods(self, &arena);
 	if (mods == NULL) {
-		PyErr_SetString(PyExc_MemoryError, "Create LDAPMods is failed.");
+		arena_free(&arena);
+		if (!PyErr_Occurred()) PyErr_SetString(PyExc_MemoryError, "Create LDAPMods is failed.");
 		return NULL;
 	}
 
-	if (mod == 0) {
-		rc = ldap_add_ext_s(self->client->ld, dnstr, mods, NULL, NULL);
+	LDAPCLIENT_BEGIN_CALL(self->client, { arena_free(&arena); return NULL; })
+	if (msgid != NULL) {
+		if (mod == 0) {
+			rc = ldap_add_ext(self->client->ld, dnstr, mods, NULL, NULL, msgid);
+		} else {
+			rc = ldap_modify_ext(self->client->ld, dnstr, mods, NULL, NULL, msgid);
+		}
 	} else {
-		rc = ldap_modify_ext_s(self->client->ld, dnstr, mods, NULL, NULL);
+		if (mod == 0) {
+			rc = ldap_add_ext_s(self->client->ld, dnstr, mods, NULL, NULL);
+		} else {
+			rc = ldap_modify_ext_s(self->client->ld, dnstr, mods, NULL, NULL);
+		}
 	}
+	LDAPCLIENT_END_CALL(self->client)
 	if (rc != LDAP_SUCCESS) {
-		//TODO Proper errors
-		PyObject *ldaperror = get_error("LDAPError");
-		PyErr_SetString(ldaperror, ldap_err2string(rc));
-		Py_DECREF(ldaperror);
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
 		LDAPEntry_DismissLDAPMods(self, mods);
-		free(dnstr);
+		arena_free(&arena);
 		return NULL;
 	}
-	free(dnstr);
 	LDAPEntry_DismissLDAPMods(self, mods);
-	return Py_None;
+	arena_free(&arena);
+	if (msgid != NULL) return LDAPClient_SetMsgId(self->client, rc, *msgid);
+	Py_RETURN_NONE;
 }
 
 static PyObject *
@@ -341,7 +757,7 @@ LDAPEntry_add(LDAPEntry *self, PyObject *args, PyObject* kwds) {
 		Py_DECREF(ldaperror);
 		return NULL;
 	}
-	return add_or_modify(self, 0);
+	return add_or_modify(self, 0, NULL);
 }
 
 static PyObject *
@@ -357,28 +773,33 @@ LDAPEntry_delete(LDAPEntry *self, PyObject *args, PyObject *kwds) {
 		return NULL;
 	}
 
+	if (keys == NULL) return NULL;
 	/* Get DN string. */
 	dnstr = PyObject2char(self->dn);
-	if (dnstr == NULL) return NULL;
-	if (LDAPClient_DelEntryStringDN(self->client, dnstr) != 0) return NULL;
-
-	if (keys == NULL) return NULL;
+	if (dnstr == NULL || LDAPClient_DelEntryStringDN(self->client, dnstr) != 0) {
+		free(dnstr);
+		Py_DECREF(keys);
+		return NULL;
+	}
+	free(dnstr);
 
 	iter = PyObject_GetIter(keys);
 	Py_DECREF(keys);
 	if (iter == NULL) return NULL;
 
 	for (key = PyIter_Next(iter); key != NULL; key = PyIter_Next(iter)) {
-		/* Return value: New reference. */
+		/* Return value: Borrowed reference. */
 		value = (LDAPValueList *)LDAPEntry_GetItem(self, key);
+		Py_DECREF(key);
 		if (value == NULL) {
 			Py_DECREF(iter);
-			Py_DECREF(key);
 			return NULL;
 		}
 		value->status = 2;
 	}
-	return Py_None;
+	Py_DECREF(iter);
+	if (PyErr_Occurred()) return NULL;
+	Py_RETURN_NONE;
 }
 
 static PyObject *
@@ -395,14 +816,14 @@ LDAPEntry_modify(LDAPEntry *self, PyObject *args, PyObject* kwds) {
 		Py_DECREF(ldaperror);
 		return NULL;
 	}
-	return add_or_modify(self, 1);
+	return add_or_modify(self, 1, NULL);
 }
 
 /*	Set distinguished name for a LDAPEntry. */
 static int
 LDAPEntry_setDN(LDAPEntry *self, PyObject *value, void *closure) {
 	PyObject *dn = NULL;
-	PyObject *ldapdn_type = load_python_object("pyLDAP.ldapdn", "LDAPDN");
+	PyObject *ldapdn_type = get_ldapdn_type();
 
 	if (ldapdn_type == NULL) return -1;
 
@@ -430,7 +851,6 @@ LDAPEntry_setDN(LDAPEntry *self, PyObject *value, void *closure) {
     	return -1;
     }
 
-	Py_DECREF(ldapdn_type);
     return 0;
 }
 
@@ -440,13 +860,17 @@ LDAPEntry_getDN(LDAPEntry *self, void *closure) {
     return self->dn;
 }
 
+/*	Rename the LDAPEntry on the server. If `msgid` is not NULL, the request is only sent,
+	and its message id is returned. */
 static PyObject *
-LDAPEntry_rename(LDAPEntry *self, PyObject *args, PyObject *kwds) {
+rename_entry(LDAPEntry *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+		int *msgid) {
 	int rc;
 	char *newparent_str, *newrdn_str, *olddn_str;
 	PyObject *newdn, *newparent, *newrdn;
 	PyObject *tmp;
-	char *kwlist[] = {"newdn", NULL};
+	PyObject *values[1];
+	static char *kwlist[] = {"newdn", NULL};
 
 	/* Client must be set. */
 	if (self->client == NULL) {
@@ -461,10 +885,11 @@ LDAPEntry_rename(LDAPEntry *self, PyObject *args, PyObject *kwds) {
 		return NULL;
 	}
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &newdn)) {
+	if (unpack_args("rename", args, nargs, kwnames, kwlist, 1, values) != 0) {
 		PyErr_SetString(PyExc_AttributeError, "Wrong parameter.");
 		return NULL;
 	}
+	newdn = values[0];
 
 	/* Save old dn string. */
 	tmp = PyObject_Str(self->dn);
@@ -485,12 +910,24 @@ LDAPEntry_rename(LDAPEntry *self, PyObject *args, PyObject *kwds) {
 	Py_DECREF(newrdn);
 	Py_DECREF(newparent);
 
-	rc = ldap_rename_s(self->client->ld, olddn_str, newrdn_str, newparent_str, 1, NULL, NULL);
+	LDAPCLIENT_BEGIN_CALL(self->client, {
+		free(olddn_str);
+		free(newrdn_str);
+		free(newparent_str);
+		return NULL;
+	})
+	if (msgid != NULL) {
+		rc = ldap_rename(self->client->ld, olddn_str, newrdn_str, newparent_str, 1, NULL, NULL, msgid);
+	} else {
+		rc = ldap_rename_s(self->client->ld, olddn_str, newrdn_str, newparent_str, 1, NULL, NULL);
+	}
+	LDAPCLIENT_END_CALL(self->client)
 	if (rc != LDAP_SUCCESS) {
-		//TODO Proper errors
-		PyObject *ldaperror = get_error("LDAPError");
-		PyErr_SetString(ldaperror, ldap_err2string(rc));
-		Py_DECREF(ldaperror);
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
 		free(olddn_str);
 		free(newrdn_str);
 		free(newparent_str);
@@ -499,18 +936,74 @@ LDAPEntry_rename(LDAPEntry *self, PyObject *args, PyObject *kwds) {
 	free(olddn_str);
 	free(newrdn_str);
 	free(newparent_str);
-	return Py_None;
+	if (msgid != NULL) return LDAPClient_SetMsgId(self->client, rc, *msgid);
+	Py_RETURN_NONE;
+}
+
+static PyObject *
+LDAPEntry_rename(LDAPEntry *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	return rename_entry(self, args, nargs, kwnames, NULL);
+}
+
+/*	Send the add request of the LDAPEntry without waiting for the response. */
+static PyObject *
+LDAPEntry_sendAdd(LDAPEntry *self) {
+	int msgid = -1;
+
+	/* Client must be set. */
+	if (self->client == NULL) {
+		PyErr_SetString(PyExc_AttributeError, "LDAPClient is not set.");
+		return NULL;
+	}
+	/* Client must be connected. */
+	if (!self->client->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+	return add_or_modify(self, 0, &msgid);
+}
+
+/*	Send the modifications of the LDAPEntry without waiting for the response. */
+static PyObject *
+LDAPEntry_sendModify(LDAPEntry *self) {
+	int msgid = -1;
+
+	/* Client must be set. */
+	if (self->client == NULL) {
+		PyErr_SetString(PyExc_AttributeError, "LDAPClient is not set.");
+		return NULL;
+	}
+	/* Client must be connected. */
+	if (!self->client->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+	return add_or_modify(self, 1, &msgid);
+}
+
+/*	Send the rename request of the LDAPEntry without waiting for the response. */
+static PyObject *
+LDAPEntry_sendRename(LDAPEntry *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
+	int msgid = -1;
+	return rename_entry(self, args, nargs, kwnames, &msgid);
 }
 
 /*	Updating LDAPEntry. Pretty much same as PyDict_Update function's codebase. */
 static PyObject *
-LDAPEntry_Update(LDAPEntry *self, PyObject *args, PyObject *kwds) {
+LDAPEntry_Update(LDAPEntry *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames) {
 	int rc = 0;
+	Py_ssize_t i;
 	PyObject *arg = NULL;
 
-	if (!PyArg_UnpackTuple(args, "update", 0, 1, &arg)) {
+	if (nargs > 1) {
+		PyErr_Format(PyExc_TypeError, "update expected at most 1 argument, got %zd", nargs);
 		rc = -1;
-	} else if (arg != NULL) {
+	} else if (nargs == 1) {
+		arg = args[0];
 		if (PyObject_HasAttrString(arg, "keys") || PyDict_Check(arg)) {
 			/* If argument is a dict, use own function to update. */
 			rc = LDAPEntry_UpdateFromDict(self, arg);
@@ -519,18 +1012,13 @@ LDAPEntry_Update(LDAPEntry *self, PyObject *args, PyObject *kwds) {
 			rc = LDAPEntry_UpdateFromSeq2(self, arg);
 		}
 	}
-	if (rc == 0 && kwds != NULL) {
-		if (PyArg_ValidateKeywordArguments(kwds)) {
-			/* If arguments are keywords, use own function to update. */
-			rc = LDAPEntry_UpdateFromDict(self, kwds);
-		} else {
-			rc = -1;
+	if (rc == 0 && kwnames != NULL) {
+		/* The keywords are set one by one, without collecting them into a dict. */
+		for (i = 0; i < PyTuple_GET_SIZE(kwnames) && rc == 0; i++) {
+			rc = LDAPEntry_SetItem(self, PyTuple_GET_ITEM(kwnames, i), args[nargs + i]);
 		}
 	}
-	if (rc != -1) {
-		Py_INCREF(Py_None); //Why?
-		return Py_None;
-	}
+	if (rc != -1) Py_RETURN_NONE;
 	return NULL;
 }
 
@@ -630,52 +1118,122 @@ static PyMethodDef LDAPEntry_methods[] = {
 	{"add", 	(PyCFunction)LDAPEntry_add,		METH_NOARGS,	"Add new LDAPEntry to LDAP server."},
 	{"delete", 	(PyCFunction)LDAPEntry_delete,	METH_NOARGS,	"Delete LDAPEntry on LDAP server."},
 	{"modify", 	(PyCFunction)LDAPEntry_modify, 	METH_NOARGS,	"Send LDAPEntry's modification to the LDAP server."},
-	{"rename", 	(PyCFunction)LDAPEntry_rename, 	METH_VARARGS | METH_KEYWORDS,	"Rename or remove LDAPEntry on the LDAP server."},
-    {"update", 	(PyCFunction)LDAPEntry_Update, 	METH_VARARGS | METH_KEYWORDS,
+	{"rename", 	(PyCFunction)LDAPEntry_rename, 	METH_FASTCALL | METH_KEYWORDS,	"Rename or remove LDAPEntry on the LDAP server."},
+	{"send_add", 	(PyCFunction)LDAPEntry_sendAdd,		METH_NOARGS,	"Send the add request, return the message id."},
+	{"send_modify", (PyCFunction)LDAPEntry_sendModify, 	METH_NOARGS,	"Send the modifications, return the message id."},
+	{"send_rename", (PyCFunction)LDAPEntry_sendRename, 	METH_FASTCALL | METH_KEYWORDS,	"Send the rename request, return the message id."},
+    {"update", 	(PyCFunction)LDAPEntry_Update, 	METH_FASTCALL | METH_KEYWORDS,
     											"Updating LDAPEntry from a dictionary." },
     {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
-/*	Searches amongs lower-cased keystrings to find a match with the key.
-  	Sets the `found` parameter's value to 1 if key found in the list, 0 otherwise. */
-PyObject *
-searchLowerCaseKeyMatch(LDAPEntry *self, PyObject *key, int* found) {
-	PyObject *keys = PyDict_Keys((PyObject *)self);
-	PyObject *iter = PyObject_GetIter(keys);
-	PyObject *item;
+/*	Returns the position of the `key` attribute among the not decoded attributes
+	of a lazy LDAPEntry, or -1 if it's not there. */
+static Py_ssize_t
+find_lazy(LDAPEntry *self, PyObject *key) {
+	Py_ssize_t i;
 
-	if (iter == NULL) {
-		Py_DECREF(keys);
-		return NULL;
+	for (i = 0; i < self->nlazy; i++) {
+		if (self->lazyattrs[i].name == key) return i;
 	}
-	/* Searching for same lowercase key amongs the other keys. */
-	for (item = PyIter_Next(iter); item != NULL; item = PyIter_Next(iter)) {
-		if (lowerCaseMatch(item, key) == 1) {
-			key = item;
-			*found = 1;
-			break;
-		}
-		*found = 0;
-		Py_DECREF(item);
+	if (!PyUnicode_Check(key)) return -1;
+	for (i = 0; i < self->nlazy; i++) {
+		if (PyUnicode_Compare(self->lazyattrs[i].name, key) == 0) return i;
 	}
-	Py_DECREF(iter);
-	Py_DECREF(keys);
-	return key;
+	return -1;
+}
+
+/*	Decodes the values of the `i`th not decoded attribute of a lazy LDAPEntry, and sets
+	them as an item. The message is released after the last attribute is decoded.
+	Returns 0 on success, -1 otherwise. */
+static int
+decode_lazy(LDAPEntry *self, Py_ssize_t i) {
+	int rc = 0, policy;
+	int tracked = PyObject_GC_IsTracked((PyObject *)self);
+	Py_ssize_t j, len;
+	const char *name;
+	LDAPLazyAttr attr = self->lazyattrs[i];
+	LDAPValueList *lvl;
+
+	name = PyUnicode_AsUTF8AndSize(attr.name, &len);
+	if (name == NULL) return -1;
+	lvl = LDAPValueList_New();
+	if (lvl == NULL) return -1;
+	policy = LDAPClient_DecodePolicy(self->client, name, len);
+	for (j = 0; rc == 0 && attr.values[j].bv_val != NULL; j++) {
+		rc = append_value(self->client, lvl, &attr.values[j], policy);
+	}
+	if (rc == 0) rc = PyDict_SetItem((PyObject *)self, attr.name, (PyObject *)lvl);
+	/* An untracked entry stays untracked. */
+	if (rc == 0 && !tracked) {
+		LDAPValueList_UnTrack(lvl);
+		PyObject_GC_UnTrack(self);
+	}
+	Py_DECREF(lvl);
+	if (rc != 0) return -1;
+
+	self->lazyattrs[i] = self->lazyattrs[--self->nlazy];
+	Py_DECREF(attr.name);
+	ldap_memfree(attr.values);
+	if (self->nlazy == 0) release_lazy(self);
+	return 0;
+}
+
+/*	Decodes every not decoded attribute of a lazy LDAPEntry. */
+static int
+decode_all(LDAPEntry *self) {
+	while (self->nlazy > 0) {
+		if (decode_lazy(self, self->nlazy - 1) != 0) return -1;
+	}
+	return 0;
+}
+
+/*	Returns the stored form of the `key` (borrowed reference), which is a
+	case-insensitive match of it, or NULL if the LDAPEntry has no such key.
+	The values of a lazy entry's matching attribute are decoded.
+	On error, returns NULL and sets an exception.
+*/
+static PyObject *
+findKey(LDAPEntry *self, PyObject *key) {
+	Py_ssize_t i;
+	PyObject *match;
+
+	if (!PyUnicode_Check(key)) return NULL;
+	/* The index could be out of sync, if the entry is modified by the dict methods. */
+	match = CaseIndex_Lookup(&self->keyindex, key);
+	if (match != NULL && self->nlazy > 0 && (i = find_lazy(self, match)) != -1) {
+		if (decode_lazy(self, i) != 0) return NULL;
+	}
+	if (match != NULL && PyDict_GetItem((PyObject *)self, match) == NULL) {
+		if (CaseIndex_Remove(&self->keyindex, match) == -1) return NULL;
+		match = NULL;
+	}
+	return match;
 }
 
 /*	Return the object from the LDAPEntry, which has a case-insensitive match. */
 PyObject *
 LDAPEntry_GetItem(LDAPEntry *self, PyObject *key) {
-	int found;
-	PyObject *match = searchLowerCaseKeyMatch(self, key, &found);
+	PyObject *value, *match;
+
+	/* Try the exact match first. */
+	value = PyDict_GetItem((PyObject *)self, key);
+	if (value != NULL) return value;
+	match = findKey(self, key);
+	if (match == NULL) return NULL;
 	return PyDict_GetItem((PyObject *)self, match);
 }
 
 /*	This is the same as LDAPEntry_GetItem(), but key is specified as a char*. */
 PyObject *
 LDAPEntry_GetItemString(LDAPEntry *self, const char *key) {
+	PyObject *value;
 	PyObject *keyobj = PyUnicode_FromString(key);
-	return LDAPEntry_GetItem(self, keyobj);
+
+	if (keyobj == NULL) return NULL;
+	value = LDAPEntry_GetItem(self, keyobj);
+	Py_DECREF(keyobj);
+	return value;
 }
 
 /*	Set item to LDAPEntry with a case-insensitive key. */
@@ -684,20 +1242,35 @@ LDAPEntry_SetItem(LDAPEntry *self, PyObject *key, PyObject *value) {
 	int found = 0;
 	int rc = 0;
 	int status = 1;
-	char *newkey = lowercase(PyObject2char(key));
+	Py_ssize_t len;
+	const char *keystr;
+	PyObject *match, *old;
 	LDAPValueList *list;
 
+	if (!PyUnicode_Check(key)) {
+		PyErr_SetString(PyExc_TypeError, "The key of an LDAPEntry must be a string.");
+		return -1;
+	}
+	keystr = PyUnicode_AsUTF8AndSize(key, &len);
+	if (keystr == NULL) return -1;
+
 	/* Search for a match. */
-	key = searchLowerCaseKeyMatch(self, key, &found);
-	if (found == 1) {
+	match = findKey(self, key);
+	if (match != NULL) {
+		key = match;
+		found = 1;
 		status = 2;
+	} else if (PyErr_Occurred()) {
+		return -1;
 	}
+	/* Hold the key, while the dict could release it. */
+	Py_INCREF(key);
 	if (value != NULL) {
 		/* If theres an item with a `dn` key, and with a string value set to the dn attribute. */
-		if (strcmp(newkey, "dn") == 0) {
+		if (len == 2 && asciiCaseEqual(keystr, "dn", 2)) {
 			if (PyUnicode_Check(value)) {
 				char *dnstr = PyObject2char(value);
-				LDAPEntry_SetStringDN(self, dnstr);
+				rc = (dnstr == NULL) ? -1 : LDAPEntry_SetStringDN(self, dnstr);
 				free(dnstr);
 			} else {
 				PyErr_SetString(PyExc_TypeError, "Distinguished name must be string type.");
@@ -709,12 +1282,27 @@ LDAPEntry_SetItem(LDAPEntry *self, PyObject *key, PyObject *value) {
 			if (LDAPValueList_Check(value) == 0) {
 				/* Convert value to LDAPValueList object. */
 				list = LDAPValueList_New();
+				if (list == NULL) {
+					Py_DECREF(key);
+					return -1;
+				}
 				if (PyList_Check(value) || PyTuple_Check(value)) {
-					LDAPValueList_Extend(list, value);
+					rc = LDAPValueList_Extend(list, value);
 				} else {
-					LDAPValueList_Append(list, value);
+					rc = LDAPValueList_Append(list, value);
+				}
+				if (rc != 0) {
+					Py_DECREF(list);
+					Py_DECREF(key);
+					return -1;
+				}
+				/* Send only the changed values of a reassigned attribute, if it's smaller. */
+				old = PyDict_GetItem((PyObject *)self, key);
+				if (found && old != NULL && LDAPValueList_Check(old) == 1) {
+					rc = LDAPValueList_Diff(list, (LDAPValueList *)old);
+					if (rc == 1) status = 1;
 				}
-				rc = PyDict_SetItem((PyObject *)self, key, (PyObject *)list);
+				if (rc != -1) rc = PyDict_SetItem((PyObject *)self, key, (PyObject *)list);
 				list->status = status;
 				Py_DECREF(list);
 			} else {
@@ -722,30 +1310,31 @@ LDAPEntry_SetItem(LDAPEntry *self, PyObject *key, PyObject *value) {
 				((LDAPValueList *)value)->status = status;
 			}
 			/* Avoid inconsistency. (same key in the added and the deleted list) */
-			if (PySequence_Contains((PyObject *)self->deleted, key)) {
-				if (UniqueList_Remove(self->deleted, key) != 0) return -1;
+			if (rc == 0 && PySequence_Contains((PyObject *)self->deleted, key)) {
+				rc = UniqueList_Remove(self->deleted, key);
 			}
-			if (rc != 0) return rc;
-			/* New key should be added to the attribute list. */
-			if (found == 0) {
-				if (UniqueList_Append(self->attributes, key) != 0) {
-					Py_DECREF(key);
-					return -1;
-				}
+			/* New key should be added to the index and the attribute list. */
+			if (rc == 0 && found == 0) {
+				rc = CaseIndex_Insert(&self->keyindex, key);
+				if (rc == 0) rc = UniqueList_Append(self->attributes, key);
 			}
 		}
 	} else {
 		/* This means, it has to remove the item. */
-		if (PyDict_DelItem((PyObject *)self, key) != 0) return -1;
-		if (UniqueList_Append(self->deleted, key) != 0) return -1;
-		/* Remove from the attributes list. */
-		if (PySequence_DelItem((PyObject *)self->attributes, PySequence_Index((PyObject *)self->attributes, key)) != 0) {
-			Py_DECREF(key);
-			return -1;
+		if (found == 0) {
+			PyErr_SetObject(PyExc_KeyError, key);
+			rc = -1;
+		} else {
+			rc = PyDict_DelItem((PyObject *)self, key);
+			if (rc == 0) rc = CaseIndex_Remove(&self->keyindex, key) == -1 ? -1 : 0;
+			if (rc == 0) rc = UniqueList_Append(self->deleted, key);
+			/* Remove from the attributes list. */
+			if (rc == 0) rc = PySequence_DelItem((PyObject *)self->attributes,
+					PySequence_Index((PyObject *)self->attributes, key));
 		}
 	}
 	Py_DECREF(key);
-	return 0;
+	return rc;
 }
 
 static PyObject *
@@ -765,8 +1354,62 @@ LDAPEntry_ass_sub(LDAPEntry *self, PyObject *key, PyObject *value) {
     else return LDAPEntry_SetItem(self, key, value);
 }
 
+/*	The length counts the not decoded attributes of a lazy entry too. */
+static Py_ssize_t
+LDAPEntry_length(LDAPEntry *self) {
+	return PyDict_Size((PyObject *)self) + self->nlazy;
+}
+
+static int
+LDAPEntry_contains(LDAPEntry *self, PyObject *key) {
+	int rc = PyDict_Contains((PyObject *)self, key);
+
+	if (rc != 0 || self->nlazy == 0) return rc;
+	return find_lazy(self, key) != -1;
+}
+
+/*	The dict's methods and the following slots work on the dict's items only,
+	so every value of a lazy entry is decoded before them. */
+static PyObject *
+LDAPEntry_getattro(LDAPEntry *self, PyObject *name) {
+	if (self->nlazy > 0 && PyObject_HasAttr((PyObject *)&PyDict_Type, name) && decode_all(self) != 0) {
+		return NULL;
+	}
+	return PyObject_GenericGetAttr((PyObject *)self, name);
+}
+
+static PyObject *
+LDAPEntry_iter(LDAPEntry *self) {
+	if (decode_all(self) != 0) return NULL;
+	return PyDict_Type.tp_iter((PyObject *)self);
+}
+
+static PyObject *
+LDAPEntry_repr(LDAPEntry *self) {
+	if (decode_all(self) != 0) return NULL;
+	return PyDict_Type.tp_repr((PyObject *)self);
+}
+
+static PyObject *
+LDAPEntry_richcompare(PyObject *self, PyObject *other, int op) {
+	if (decode_all((LDAPEntry *)self) != 0) return NULL;
+	if (PyObject_TypeCheck(other, &LDAPEntryType) && decode_all((LDAPEntry *)other) != 0) return NULL;
+	return PyDict_Type.tp_richcompare(self, other, op);
+}
+
+static PySequenceMethods LDAPEntry_sequence_meths = {
+	0,									/* sq_length */
+	0,									/* sq_concat */
+	0,									/* sq_repeat */
+	0,									/* sq_item */
+	0,									/* was_sq_slice */
+	0,									/* sq_ass_item */
+	0,									/* was_sq_ass_slice */
+	(objobjproc)LDAPEntry_contains,		/* sq_contains */
+};
+
 static PyMappingMethods LDAPEntry_mapping_meths = {
-	0, 									/* mp_length */
+	(lenfunc)LDAPEntry_length,			/* mp_length */
 	(binaryfunc)LDAPEntry_subscript,	/* mp_subscript */
 	(objobjargproc)LDAPEntry_ass_sub, 	/* mp_ass_subscript */
 };
@@ -809,7 +1452,7 @@ LDAPEntry_setClient(LDAPEntry *self, PyObject *value, void *closure) {
 static PyObject *
 LDAPEntry_getClient(LDAPEntry *self, void *closure) {
 	if (self->client == NULL) {
-		return Py_None;
+		Py_RETURN_NONE;
 	}
     Py_INCREF(self->client);
     return (PyObject *)self->client;
@@ -817,9 +1460,13 @@ LDAPEntry_getClient(LDAPEntry *self, void *closure) {
 
 int
 LDAPEntry_SetStringDN(LDAPEntry *self, char *value) {
+	int rc;
 	PyObject *dn = PyUnicode_FromString(value);
+
 	if (dn == NULL) return -1;
-	return LDAPEntry_setDN(self, dn, NULL);
+	rc = LDAPEntry_setDN(self, dn, NULL);
+	Py_DECREF(dn);
+	return rc;
 }
 
 static PyObject *
@@ -862,14 +1509,14 @@ PyTypeObject LDAPEntryType = {
     0,                       /* tp_getattr */
     0,                       /* tp_setattr */
     0,                       /* tp_reserved */
-    0,                       /* tp_repr */
+    (reprfunc)LDAPEntry_repr,/* tp_repr */
     0,                       /* tp_as_number */
-    0,                       /* tp_as_sequence */
+    &LDAPEntry_sequence_meths,/* tp_as_sequence */
     &LDAPEntry_mapping_meths,/* tp_as_mapping */
     0,                       /* tp_hash */
     0,                       /* tp_call */
     0,                       /* tp_str */
-    0,                       /* tp_getattro */
+    (getattrofunc)LDAPEntry_getattro,/* tp_getattro */
     0,                       /* tp_setattro */
     0,                       /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT |
@@ -878,9 +1525,9 @@ PyTypeObject LDAPEntryType = {
     0,                       /* tp_doc */
     (traverseproc)LDAPEntry_traverse,/* tp_traverse */
     (inquiry)LDAPEntry_clear, /* tp_clear */
-    0,                       /* tp_richcompare */
+    LDAPEntry_richcompare,   /* tp_richcompare */
     0,                       /* tp_weaklistoffset */
-    0,                       /* tp_iter */
+    (getiterfunc)LDAPEntry_iter,/* tp_iter */
     0,                       /* tp_iternext */
     LDAPEntry_methods,       /* tp_methods */
     0,       				 /* tp_members */
@@ -891,6 +1538,7 @@ PyTypeObject LDAPEntryType = {
     0,                       /* tp_descr_set */
     0,                       /* tp_dictoffset */
     (initproc)LDAPEntry_init,/* tp_init */
-    0,                       /* tp_alloc */
+    LDAPEntry_alloc,         /* tp_alloc */
     LDAPEntry_new,           /* tp_new */
+    LDAPEntry_free,          /* tp_free */
 };
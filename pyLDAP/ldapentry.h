@@ -18,6 +18,21 @@
 
 #include "ldapclient.h"
 #include "ldapvaluelist.h"
+#include "caseindex.h"
+#include "attrlayout.h"
+#include "utils.h"
+
+/* Options of the LDAPEntries created from a search result. */
+#define _LDAP_ENTRY_LAZY 0x1
+#define _LDAP_ENTRY_FROZEN 0x2
+#define _LDAP_ENTRY_COLUMNAR 0x4
+#define _LDAP_ENTRY_UNTRACKED 0x8
+
+/* An attribute of a lazy LDAPEntry, whose values are not decoded yet. */
+typedef struct {
+	PyObject *name;
+	struct berval *values;
+} LDAPLazyAttr;
 
 typedef struct {
     PyDictObject dict;
@@ -25,15 +40,25 @@ typedef struct {
     UniqueList *attributes;
     UniqueList *deleted;
     LDAPClient *client;
+    CaseIndex keyindex;
+    PyObject *msgowner;
+    LDAPLazyAttr *lazyattrs;
+    Py_ssize_t nlazy;
 } LDAPEntry;
 
 extern PyTypeObject LDAPEntryType;
 
 LDAPEntry *LDAPEntry_New(void);
+void LDAPEntry_ClearFreeList(void);
 int LDAPEntry_Check(PyObject *obj);
-LDAPMod **LDAPEntry_CreateLDAPMods(LDAPEntry *self);
+LDAPMod **LDAPEntry_CreateLDAPMods(LDAPEntry *self, LDAPArena *arena);
 void LDAPEntry_DismissLDAPMods(LDAPEntry *self, LDAPMod **mods);
-LDAPEntry *LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client);
+LDAPEntry *LDAPEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client, PyObject *msgowner,
+		AttrLayout *layout);
+PyObject *LDAPEntry_Create(LDAPMessage *entrymsg, LDAPClient *client, int flags, PyObject *msgowner,
+		AttrLayout *layout);
+int LDAPEntry_AddReceived(LDAPEntry *self, PyObject *attrobj, PyObject *values);
+int LDAPEntry_FetchRanges(LDAPClient *client, PyObject *entries);
 int LDAPEntry_UpdateFromDict(LDAPEntry *self, PyObject *dict);
 int LDAPEntry_UpdateFromSeq2(LDAPEntry *self, PyObject *seq);
 PyObject *LDAPEntry_GetItem(LDAPEntry *self, PyObject *key);
@@ -0,0 +1,454 @@
+#include "utils.h"
+
+#include "ldapentry.h"
+#include "ldapfrozenentry.h"
+
+static int
+LDAPFrozenEntry_clear(LDAPFrozenEntry *self) {
+	Py_CLEAR(self->dn);
+	Py_CLEAR(self->client);
+	Py_CLEAR(self->layout);
+	PyDict_Type.tp_clear((PyObject *)self);
+	return 0;
+}
+
+/*	Deallocate the LDAPFrozenEntry. */
+static void
+LDAPFrozenEntry_dealloc(LDAPFrozenEntry *self) {
+	PyObject_GC_UnTrack(self);
+	LDAPFrozenEntry_clear(self);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int
+LDAPFrozenEntry_traverse(LDAPFrozenEntry *self, visitproc visit, void *arg) {
+	Py_VISIT(self->client);
+	return PyDict_Type.tp_traverse((PyObject *)self, visit, arg);
+}
+
+/*	The LDAPFrozenEntries are created only by the frozen searches. */
+static PyObject *
+LDAPFrozenEntry_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+	PyErr_SetString(PyExc_TypeError, "LDAPFrozenEntry cannot be created directly, "
+			"it is returned by the searches with frozen=True.");
+	return NULL;
+}
+
+/*	Creates a new, empty LDAPFrozenEntry for internal use. Without a shared
+	`layout`, the entry gets its own one. */
+static LDAPFrozenEntry *
+LDAPFrozenEntry_New(LDAPClient *client, AttrLayout *layout) {
+	LDAPFrozenEntry *self;
+
+	self = (LDAPFrozenEntry *)PyDict_Type.tp_new(&LDAPFrozenEntryType, NULL, NULL);
+	if (self == NULL) return NULL;
+	Py_INCREF(client);
+	self->client = client;
+	if (layout == NULL) {
+		self->layout = AttrLayout_New();
+		if (self->layout == NULL) {
+			Py_DECREF(self);
+			return NULL;
+		}
+	} else {
+		Py_INCREF(layout);
+		self->layout = layout;
+	}
+	return self;
+}
+
+/*	Creates a tuple of the `values` bervals converted by the decoding policy of the `attr`
+	attribute. The `values` is an array of `count` berval pointers. */
+static PyObject *
+create_values(LDAPClient *client, const char *attr, Py_ssize_t len, struct berval **values,
+		Py_ssize_t count) {
+	int policy = LDAPClient_DecodePolicy(client, attr, len);
+	Py_ssize_t i;
+	PyObject *val;
+	PyObject *tuple = PyTuple_New(count);
+
+	if (tuple == NULL) return NULL;
+	for (i = 0; i < count; i++) {
+		val = LDAPClient_DecodeValue(client, values[i], policy);
+		if (val == NULL) {
+			Py_DECREF(tuple);
+			return NULL;
+		}
+		PyTuple_SET_ITEM(tuple, i, val);
+	}
+	return tuple;
+}
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+/*	Create a LDAPFrozenEntry from a LDAPMessage. */
+LDAPFrozenEntry *
+LDAPFrozenEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client, AttrLayout *layout) {
+	Py_ssize_t count, pos = 0;
+	char *dn;
+	char *attr = NULL;
+	struct berval **values = NULL;
+	BerElement *ber = NULL;
+	PyObject *attrobj = NULL;
+	PyObject *tuple = NULL;
+	LDAPFrozenEntry *self;
+
+	self = LDAPFrozenEntry_New(client, layout);
+	if (self == NULL) return NULL;
+
+	dn = ldap_get_dn(client->ld, entrymsg);
+	if (dn != NULL) {
+		self->dn = PyUnicode_FromString(dn);
+		ldap_memfree(dn);
+		if (self->dn == NULL) goto Fail;
+	}
+
+	/* Iterate over the LDAP attributes. */
+	for (attr = ldap_first_attribute(client->ld, entrymsg, &ber);
+		attr != NULL; attr = ldap_next_attribute(client->ld, entrymsg, ber)) {
+		attrobj = AttrLayout_GetName(self->layout, pos++, attr, strlen(attr));
+		if (attrobj == NULL) goto Fail;
+		values = ldap_get_values_len(client->ld, entrymsg, attr);
+		count = 0;
+		if (values != NULL) {
+			while (values[count] != NULL) count++;
+		}
+		tuple = create_values(client, attr, strlen(attr), values, count);
+		if (tuple == NULL) goto Fail;
+		if (values != NULL) ldap_value_free_len(values);
+		values = NULL;
+		if (PyDict_SetItem((PyObject *)self, attrobj, tuple) != 0) goto Fail;
+		Py_CLEAR(attrobj);
+		Py_CLEAR(tuple);
+		ldap_memfree(attr);
+	}
+	if (ber != NULL) ber_free(ber, 0);
+	return self;
+
+Fail:
+	Py_XDECREF(attrobj);
+	Py_XDECREF(tuple);
+	Py_DECREF(self);
+	if (values != NULL) ldap_value_free_len(values);
+	if (attr != NULL) ldap_memfree(attr);
+	if (ber != NULL) ber_free(ber, 0);
+	return NULL;
+}
+
+#else
+
+/*	Create a LDAPFrozenEntry from a LDAPMessage. The DN, the attributes' names and
+	values are decoded in place from the message's BER buffer, the names are taken
+	from the `layout` shared by the entries of the result. */
+LDAPFrozenEntry *
+LDAPFrozenEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client, AttrLayout *layout) {
+	int rc;
+	Py_ssize_t i, count, pos = 0, size = 0;
+	struct berval dn, attr;
+	struct berval *values = NULL;
+	struct berval **ptrs = NULL, **tmp;
+	BerElement *ber = NULL;
+	PyObject *attrobj = NULL;
+	PyObject *tuple = NULL;
+	LDAPFrozenEntry *self;
+
+	self = LDAPFrozenEntry_New(client, layout);
+	if (self == NULL) return NULL;
+
+	rc = ldap_get_dn_ber(client->ld, entrymsg, &ber, &dn);
+	if (rc != LDAP_SUCCESS) goto Error;
+	if (dn.bv_val != NULL) {
+		self->dn = PyUnicode_DecodeUTF8(dn.bv_val, dn.bv_len, NULL);
+		if (self->dn == NULL) goto Fail;
+	}
+
+	/* Iterate over the LDAP attributes, `values` is an array of borrowed bervals. */
+	for (rc = ldap_get_attribute_ber(client->ld, entrymsg, ber, &attr, &values);
+		rc == LDAP_SUCCESS && attr.bv_val != NULL;
+		rc = ldap_get_attribute_ber(client->ld, entrymsg, ber, &attr, &values)) {
+		attrobj = AttrLayout_GetName(self->layout, pos++, attr.bv_val, attr.bv_len);
+		if (attrobj == NULL) goto Fail;
+		count = 0;
+		if (values != NULL) {
+			while (values[count].bv_val != NULL) count++;
+		}
+		/* The pointers' array is reused for every attribute. */
+		if (count > size) {
+			tmp = (struct berval **)realloc(ptrs, sizeof(struct berval *) * count);
+			if (tmp == NULL) {
+				PyErr_NoMemory();
+				goto Fail;
+			}
+			ptrs = tmp;
+			size = count;
+		}
+		for (i = 0; i < count; i++) ptrs[i] = &values[i];
+		tuple = create_values(client, attr.bv_val, attr.bv_len, ptrs, count);
+		if (tuple == NULL) goto Fail;
+		if (values != NULL) ber_memfree(values);
+		values = NULL;
+		if (PyDict_SetItem((PyObject *)self, attrobj, tuple) != 0) goto Fail;
+		Py_CLEAR(attrobj);
+		Py_CLEAR(tuple);
+	}
+	if (rc != LDAP_SUCCESS) goto Error;
+	ber_free(ber, 0);
+	free(ptrs);
+	return self;
+
+Error:
+	{
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+	}
+Fail:
+	Py_XDECREF(attrobj);
+	Py_XDECREF(tuple);
+	Py_DECREF(self);
+	free(ptrs);
+	if (values != NULL) ber_memfree(values);
+	if (ber != NULL) ber_free(ber, 0);
+	return NULL;
+}
+
+#endif
+
+/*	Untracks the LDAPFrozenEntry and its tuples of strings and bytes
+	by the garbage collector, they cannot be a part of a cycle. */
+void
+LDAPFrozenEntry_UnTrack(LDAPFrozenEntry *self) {
+	Py_ssize_t pos = 0;
+	PyObject *key, *value;
+
+	while (PyDict_Next((PyObject *)self, &pos, &key, &value)) {
+		PyObject_GC_UnTrack(value);
+	}
+	PyObject_GC_UnTrack(self);
+}
+
+/*	Returns a mutable LDAPEntry with the same DN and values, which can be modified
+	and sent to the server. */
+static PyObject *
+LDAPFrozenEntry_toEntry(LDAPFrozenEntry *self) {
+	Py_ssize_t pos = 0;
+	PyObject *key, *value;
+	const char *dnstr;
+	LDAPEntry *entry;
+
+	entry = LDAPEntry_New();
+	if (entry == NULL) return NULL;
+	if (self->client != NULL && LDAPEntry_SetClient(entry, self->client) != 0) goto Fail;
+	if (self->dn != NULL) {
+		dnstr = PyUnicode_AsUTF8(self->dn);
+		if (dnstr == NULL || LDAPEntry_SetStringDN(entry, (char *)dnstr) != 0) goto Fail;
+	}
+	while (PyDict_Next((PyObject *)self, &pos, &key, &value)) {
+		if (LDAPEntry_AddReceived(entry, key, value) != 0) goto Fail;
+	}
+	return (PyObject *)entry;
+
+Fail:
+	Py_DECREF(entry);
+	return NULL;
+}
+
+/*	Every method, that would modify the LDAPFrozenEntry, raises TypeError. */
+static PyObject *
+LDAPFrozenEntry_readOnly(LDAPFrozenEntry *self, PyObject *args, PyObject *kwds) {
+	PyErr_SetString(PyExc_TypeError, "LDAPFrozenEntry is read-only, use to_entry() to modify it.");
+	return NULL;
+}
+
+/*	Returns the value of the key, which is a case-insensitive match of the `key`,
+	or NULL if there is no such key. The layout has only one of the names, which differ
+	only in case, so the keys are checked one by one, when the indexed name is missing. */
+static PyObject *
+find_value(LDAPFrozenEntry *self, PyObject *key) {
+	Py_ssize_t pos = 0;
+	PyObject *match, *name, *value;
+
+	match = CaseIndex_Lookup(&self->layout->index, key);
+	if (match != NULL) {
+		value = PyDict_GetItem((PyObject *)self, match);
+		if (value != NULL) return value;
+	}
+	while (PyDict_Next((PyObject *)self, &pos, &name, &value)) {
+		if (lowerCaseMatch(name, key) == 1) return value;
+	}
+	return NULL;
+}
+
+/*	Returns the values of the attribute, which is a case-insensitive match of the `key`
+	(the exact match is tried first), or NULL if there is no such attribute. */
+static PyObject *
+lookup(LDAPFrozenEntry *self, PyObject *key) {
+	PyObject *value = PyDict_GetItem((PyObject *)self, key);
+
+	if (value == NULL && PyUnicode_Check(key)) value = find_value(self, key);
+	return value;
+}
+
+/*	Return the values from the LDAPFrozenEntry, which has a case-insensitive match. */
+static PyObject *
+LDAPFrozenEntry_subscript(LDAPFrozenEntry *self, PyObject *key) {
+	PyObject *value = lookup(self, key);
+
+	if (value == NULL) {
+		PyErr_Format(PyExc_KeyError, "Key '%R' is not in the LDAPFrozenEntry.", key);
+		return NULL;
+	}
+	Py_INCREF(value);
+	return value;
+}
+
+/*	Case-insensitive `in` operator, like the subscript. */
+static int
+LDAPFrozenEntry_contains(LDAPFrozenEntry *self, PyObject *key) {
+	return lookup(self, key) != NULL;
+}
+
+/*	Case-insensitive get(key[, default]), like the subscript. */
+static PyObject *
+LDAPFrozenEntry_get(LDAPFrozenEntry *self, PyObject *const *args, Py_ssize_t nargs) {
+	PyObject *value;
+
+	if (nargs < 1 || nargs > 2) {
+		PyErr_Format(PyExc_TypeError, "get expected 1 or 2 arguments, got %zd", nargs);
+		return NULL;
+	}
+	value = lookup(self, args[0]);
+	if (value == NULL) value = (nargs == 2) ? args[1] : Py_None;
+	Py_INCREF(value);
+	return value;
+}
+
+static PyMethodDef LDAPFrozenEntry_methods[] = {
+	{"to_entry", (PyCFunction)LDAPFrozenEntry_toEntry, METH_NOARGS,
+			"Return a mutable LDAPEntry with the same DN and values."},
+	{"get", (PyCFunction)LDAPFrozenEntry_get, METH_FASTCALL,
+			"Return the values of the attribute (case-insensitive), or the default."},
+	{"clear", (PyCFunction)LDAPFrozenEntry_readOnly, METH_VARARGS | METH_KEYWORDS, NULL},
+	{"pop", (PyCFunction)LDAPFrozenEntry_readOnly, METH_VARARGS | METH_KEYWORDS, NULL},
+	{"popitem", (PyCFunction)LDAPFrozenEntry_readOnly, METH_VARARGS | METH_KEYWORDS, NULL},
+	{"setdefault", (PyCFunction)LDAPFrozenEntry_readOnly, METH_VARARGS | METH_KEYWORDS, NULL},
+	{"update", (PyCFunction)LDAPFrozenEntry_readOnly, METH_VARARGS | METH_KEYWORDS, NULL},
+	{NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static int
+LDAPFrozenEntry_init(LDAPFrozenEntry *self, PyObject *args, PyObject *kwds) {
+	LDAPFrozenEntry_readOnly(self, args, kwds);
+	return -1;
+}
+
+static int
+LDAPFrozenEntry_ass_sub(LDAPFrozenEntry *self, PyObject *key, PyObject *value) {
+	PyErr_SetString(PyExc_TypeError, "LDAPFrozenEntry is read-only, use to_entry() to modify it.");
+	return -1;
+}
+
+static PyObject *
+LDAPFrozenEntry_inplaceOr(PyObject *self, PyObject *other) {
+	return LDAPFrozenEntry_readOnly((LDAPFrozenEntry *)self, NULL, NULL);
+}
+
+static PyNumberMethods LDAPFrozenEntry_number_meths = {
+	.nb_inplace_or = LDAPFrozenEntry_inplaceOr,
+};
+
+static PySequenceMethods LDAPFrozenEntry_sequence_meths = {
+	0,										/* sq_length */
+	0,										/* sq_concat */
+	0,										/* sq_repeat */
+	0,										/* sq_item */
+	0,										/* was_sq_slice */
+	0,										/* sq_ass_item */
+	0,										/* was_sq_ass_slice */
+	(objobjproc)LDAPFrozenEntry_contains,	/* sq_contains */
+};
+
+static PyMappingMethods LDAPFrozenEntry_mapping_meths = {
+	0,										/* mp_length */
+	(binaryfunc)LDAPFrozenEntry_subscript,	/* mp_subscript */
+	(objobjargproc)LDAPFrozenEntry_ass_sub,	/* mp_ass_subscript */
+};
+
+static PyObject *
+LDAPFrozenEntry_getDN(LDAPFrozenEntry *self, void *closure) {
+	if (self->dn == NULL) return PyUnicode_FromString("");
+	Py_INCREF(self->dn);
+	return self->dn;
+}
+
+static PyObject *
+LDAPFrozenEntry_getClient(LDAPFrozenEntry *self, void *closure) {
+	if (self->client == NULL) Py_RETURN_NONE;
+	Py_INCREF(self->client);
+	return (PyObject *)self->client;
+}
+
+static PyObject *
+LDAPFrozenEntry_getAttributes(LDAPFrozenEntry *self, void *closure) {
+	PyObject *tuple;
+	PyObject *keys = PyDict_Keys((PyObject *)self);
+
+	if (keys == NULL) return NULL;
+	tuple = PyList_AsTuple(keys);
+	Py_DECREF(keys);
+	return tuple;
+}
+
+static PyGetSetDef LDAPFrozenEntry_getsetters[] = {
+	{"attributes",	(getter)LDAPFrozenEntry_getAttributes, NULL,
+					"Tuple of attributes", NULL},
+	{"client", 		(getter)LDAPFrozenEntry_getClient, NULL,
+					"LDAP client.", NULL},
+	{"dn", 			(getter)LDAPFrozenEntry_getDN, NULL,
+					"Distinguished name (string)", NULL},
+	{NULL}  /* Sentinel */
+};
+
+PyTypeObject LDAPFrozenEntryType = {
+	PyObject_HEAD_INIT(NULL)
+	"pyLDAP.LDAPFrozenEntry",	/* tp_name */
+	sizeof(LDAPFrozenEntry),	/* tp_basicsize */
+	0,							/* tp_itemsize */
+	(destructor)LDAPFrozenEntry_dealloc, /* tp_dealloc */
+	0,							/* tp_print */
+	0,							/* tp_getattr */
+	0,							/* tp_setattr */
+	0,							/* tp_reserved */
+	0,							/* tp_repr */
+	&LDAPFrozenEntry_number_meths, /* tp_as_number */
+	&LDAPFrozenEntry_sequence_meths, /* tp_as_sequence */
+	&LDAPFrozenEntry_mapping_meths, /* tp_as_mapping */
+	0,							/* tp_hash */
+	0,							/* tp_call */
+	0,							/* tp_str */
+	0,							/* tp_getattro */
+	0,							/* tp_setattro */
+	0,							/* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT |
+		Py_TPFLAGS_HAVE_GC,		/* tp_flags */
+	"Read-only LDAP entry of a frozen search.", /* tp_doc */
+	(traverseproc)LDAPFrozenEntry_traverse, /* tp_traverse */
+	(inquiry)LDAPFrozenEntry_clear, /* tp_clear */
+	0,							/* tp_richcompare */
+	0,							/* tp_weaklistoffset */
+	0,							/* tp_iter */
+	0,							/* tp_iternext */
+	LDAPFrozenEntry_methods,	/* tp_methods */
+	0,							/* tp_members */
+	LDAPFrozenEntry_getsetters,	/* tp_getset */
+	0,							/* tp_base */
+	0,							/* tp_dict */
+	0,							/* tp_descr_get */
+	0,							/* tp_descr_set */
+	0,							/* tp_dictoffset */
+	(initproc)LDAPFrozenEntry_init, /* tp_init */
+	0,							/* tp_alloc */
+	LDAPFrozenEntry_new,		/* tp_new */
+};
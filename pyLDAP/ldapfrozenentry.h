@@ -0,0 +1,38 @@
+#ifndef LDAPFROZENENTRY_H_
+#define LDAPFROZENENTRY_H_
+
+#include <Python.h>
+#include "structmember.h"
+
+//MS Windows
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+#include <windows.h>
+#include <winldap.h>
+
+//Unix
+#else
+#include <ldap.h>
+
+#endif
+
+#include "ldapclient.h"
+#include "attrlayout.h"
+
+/*	Read-only entry of a frozen search. The values are stored in tuples,
+	and there is no change tracking, the DN is a plain string. The names and
+	their case-insensitive index are shared by the entries of the result. */
+typedef struct {
+	PyDictObject dict;
+	PyObject *dn;
+	LDAPClient *client;
+	AttrLayout *layout;
+} LDAPFrozenEntry;
+
+extern PyTypeObject LDAPFrozenEntryType;
+
+LDAPFrozenEntry *LDAPFrozenEntry_FromLDAPMessage(LDAPMessage *entrymsg, LDAPClient *client,
+		AttrLayout *layout);
+void LDAPFrozenEntry_UnTrack(LDAPFrozenEntry *self);
+
+#endif /* LDAPFROZENENTRY_H_ */
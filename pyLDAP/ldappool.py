@@ -0,0 +1,214 @@
+import collections
+import contextlib
+import threading
+import time
+
+from pyLDAP._cpyLDAP import LDAPClient
+import pyLDAP.errors
+
+class LDAPConnectionPool(object):
+    __slots__ = ("__url", "__tls", "__args", "__kwargs", "__size", "__check_interval",
+                 "__lock", "__available", "__idle", "__in_use", "__closed",
+                 "__created", "__discarded", "__checkouts", "__wait_time", "__max_wait_time")
+
+    def __init__(self, url="ldap://localhost/", size=10, tls=False, *args,
+                 check_interval=30.0, **kwargs):
+        """
+            Thread-safe pool of bound LDAPClients. The connections are opened
+            and bound with the same arguments, that are passed to the
+            LDAPClient.connect method, and they are handed out by the
+            `connection` context manager.
+            :param url: String representation of a valid LDAP URL.
+            :param size: The number of the connections.
+            :param tls: Start TLS session after connecting.
+            :param check_interval: The connections, which are idle for longer
+            than this (in seconds), are checked with a Who Am I operation
+            before handing them out. With 0 every checkout is checked.
+        """
+        if size < 1:
+            raise ValueError("The size of the pool must be positive.")
+        self.__url = url
+        self.__tls = tls
+        self.__args = args
+        self.__kwargs = kwargs
+        self.__size = size
+        self.__check_interval = check_interval
+        self.__lock = threading.Lock()
+        self.__available = threading.Condition(self.__lock)
+        # Idle connections with the time of their last use.
+        self.__idle = collections.deque()
+        self.__in_use = 0
+        self.__closed = False
+        self.__created = 0
+        self.__discarded = 0
+        self.__checkouts = 0
+        self.__wait_time = 0.0
+        self.__max_wait_time = 0.0
+        try:
+            for _ in range(size):
+                self.__idle.append((self.__create(), time.monotonic()))
+        except:
+            # Unbind the already opened connections, the clients don't do it on deletion.
+            while self.__idle:
+                self.__discard(self.__idle.popleft()[0], False)
+            raise
+
+    def __create(self):
+        """ Opens and binds a new connection. """
+        client = LDAPClient(self.__url, self.__tls)
+        client.connect(*self.__args, **self.__kwargs)
+        with self.__lock:
+            self.__created += 1
+        return client
+
+    def __discard(self, client, count=True):
+        """ Closes a dead or unwanted connection. """
+        try:
+            client.close()
+        except pyLDAP.errors.LDAPError:
+            pass
+        if count:
+            with self.__lock:
+                self.__discarded += 1
+
+    def __check(self, client):
+        """ Returns True, if the connection is still alive. """
+        try:
+            client.whoami()
+        except pyLDAP.errors.LDAPError:
+            return False
+        return True
+
+    @property
+    def url(self):
+        """ The LDAP URL of the pooled connections. """
+        return self.__url
+
+    @property
+    def size(self):
+        """ The maximal number of the connections. """
+        return self.__size
+
+    @property
+    def closed(self):
+        """ True, if the pool is closed. """
+        return self.__closed
+
+    @property
+    def stats(self):
+        """
+            Statistics of the pool: the number of the connections in use and
+            idle, the created and discarded connections, the checkouts, and
+            the total and the longest time (in seconds) of waiting for a
+            free connection.
+        """
+        with self.__lock:
+            return {"in_use": self.__in_use,
+                    "idle": len(self.__idle),
+                    "created": self.__created,
+                    "discarded": self.__discarded,
+                    "checkouts": self.__checkouts,
+                    "wait_time": self.__wait_time,
+                    "max_wait_time": self.__max_wait_time}
+
+    def get(self, timeout=None):
+        """
+            Checks out a bound LDAPClient. Blocks until a connection is
+            free. The dead idle connections are replaced with new ones.
+            The client must be returned with the `put` method.
+            :param timeout: Waiting for a free connection at most this
+            long (in seconds), then raises a TimeoutError.
+        """
+        start = time.monotonic()
+        with self.__lock:
+            while not self.__closed and len(self.__idle) == 0 \
+                    and self.__in_use >= self.__size:
+                remaining = None
+                if timeout is not None:
+                    remaining = timeout - (time.monotonic() - start)
+                    if remaining <= 0:
+                        raise TimeoutError("No free connection in the pool.")
+                self.__available.wait(remaining)
+            if self.__closed:
+                raise pyLDAP.errors.NotConnected("The connection pool is closed.")
+            wait = time.monotonic() - start
+            self.__wait_time += wait
+            self.__max_wait_time = max(self.__max_wait_time, wait)
+            self.__checkouts += 1
+            self.__in_use += 1
+            if len(self.__idle) > 0:
+                client, last_used = self.__idle.pop()
+            else:
+                # A discarded connection is replaced.
+                client, last_used = None, None
+        try:
+            if client is not None and \
+                    time.monotonic() - last_used >= self.__check_interval \
+                    and not self.__check(client):
+                self.__discard(client)
+                client = None
+            if client is None:
+                client = self.__create()
+        except:
+            with self.__lock:
+                self.__in_use -= 1
+                self.__available.notify()
+            raise
+        return client
+
+    def put(self, client, discard=False):
+        """
+            Returns the checked out `client` to the pool.
+            :param discard: Close the connection instead of reusing it.
+        """
+        with self.__lock:
+            self.__in_use -= 1
+            closed = self.__closed
+            if not discard and not closed:
+                self.__idle.append((client, time.monotonic()))
+            self.__available.notify()
+        if discard or closed:
+            self.__discard(client, discard)
+
+    @contextlib.contextmanager
+    def connection(self, timeout=None):
+        """
+            Context manager of a checked out LDAPClient. When the block
+            raises a connection error, the connection is discarded, and
+            replaced by a new one later.
+            :param timeout: The same as the `get` method's.
+        """
+        client = self.get(timeout)
+        try:
+            yield client
+        except (pyLDAP.errors.ConnectionError, pyLDAP.errors.NotConnected):
+            self.put(client, discard=True)
+            raise
+        except pyLDAP.errors.LDAPError:
+            # Keep the connection only if it survived the error.
+            self.put(client, discard=not self.__check(client))
+            raise
+        except:
+            self.put(client)
+            raise
+        else:
+            self.put(client)
+
+    def close(self):
+        """
+            Closes the idle connections. The connections in use are closed,
+            when they are returned.
+        """
+        with self.__lock:
+            self.__closed = True
+            idle = [client for client, _ in self.__idle]
+            self.__idle.clear()
+            self.__available.notify_all()
+        for client in idle:
+            self.__discard(client, False)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
@@ -0,0 +1,763 @@
+#include "utils.h"
+
+#include "ldapentry.h"
+#include "ldapresultset.h"
+
+/*	Initialises an empty LDAPValueBuffer. Returns 0 on success, -1 otherwise. */
+static int
+buffer_init(LDAPValueBuffer *buf) {
+	buf->osize = 16;
+	buf->offsets = (Py_ssize_t *)malloc(sizeof(Py_ssize_t) * buf->osize);
+	if (buf->offsets == NULL) {
+		PyErr_NoMemory();
+		return -1;
+	}
+	buf->offsets[0] = 0;
+	return 0;
+}
+
+/*	Appends the `len` long `val` to the buffer. Returns 0 on success, -1 otherwise. */
+static int
+buffer_append(LDAPValueBuffer *buf, const char *val, Py_ssize_t len) {
+	char *data;
+	Py_ssize_t size;
+	Py_ssize_t *offsets;
+
+	if (buf->len + len > buf->size) {
+		size = (buf->size == 0) ? 1024 : buf->size * 2;
+		while (size < buf->len + len) size *= 2;
+		data = (char *)realloc(buf->data, size);
+		if (data == NULL) {
+			PyErr_NoMemory();
+			return -1;
+		}
+		buf->data = data;
+		buf->size = size;
+	}
+	if (buf->count + 2 > buf->osize) {
+		offsets = (Py_ssize_t *)realloc(buf->offsets, sizeof(Py_ssize_t) * buf->osize * 2);
+		if (offsets == NULL) {
+			PyErr_NoMemory();
+			return -1;
+		}
+		buf->offsets = offsets;
+		buf->osize *= 2;
+	}
+	if (len > 0) memcpy(buf->data + buf->len, val, len);
+	buf->len += len;
+	buf->count++;
+	buf->offsets[buf->count] = buf->len;
+	return 0;
+}
+
+static void
+buffer_free(LDAPValueBuffer *buf) {
+	free(buf->data);
+	free(buf->offsets);
+}
+
+/*	The client can keep the LDAPResultSet in its results, while the set refers to it. */
+static int
+LDAPResultSet_clear(LDAPResultSet *self) {
+	Py_CLEAR(self->client);
+	return 0;
+}
+
+static int
+LDAPResultSet_traverse(LDAPResultSet *self, visitproc visit, void *arg) {
+	Py_VISIT(self->client);
+	return 0;
+}
+
+/*	Deallocate the LDAPResultSet. */
+static void
+LDAPResultSet_dealloc(LDAPResultSet *self) {
+	Py_ssize_t i;
+
+	PyObject_GC_UnTrack(self);
+	for (i = 0; i < self->ncolumns; i++) {
+		Py_DECREF(self->columns[i].name);
+		free(self->columns[i].rows);
+		buffer_free(&self->columns[i].values);
+	}
+	free(self->columns);
+	buffer_free(&self->dns);
+	CaseIndex_Clear(&self->index);
+	LDAPResultSet_clear(self);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/*	Creates a new, empty LDAPResultSet for internal use. */
+LDAPResultSet *
+LDAPResultSet_New(LDAPClient *client) {
+	LDAPResultSet *self;
+
+	self = (LDAPResultSet *)LDAPResultSetType.tp_alloc(&LDAPResultSetType, 0);
+	if (self == NULL) return NULL;
+	Py_INCREF(client);
+	self->client = client;
+	if (buffer_init(&self->dns) != 0) {
+		Py_DECREF(self);
+		return NULL;
+	}
+	return self;
+}
+
+/*	Makes room for a new row in the rows' indexes of the columns.
+	Returns 0 on success, -1 otherwise. */
+static int
+reserve_row(LDAPResultSet *self) {
+	Py_ssize_t i, size;
+	Py_ssize_t *rows;
+
+	if (self->nrows < self->rowsize) return 0;
+	size = (self->rowsize == 0) ? 64 : self->rowsize * 2;
+	for (i = 0; i < self->ncolumns; i++) {
+		rows = (Py_ssize_t *)realloc(self->columns[i].rows, sizeof(Py_ssize_t) * (size + 1));
+		if (rows == NULL) {
+			PyErr_NoMemory();
+			return -1;
+		}
+		self->columns[i].rows = rows;
+	}
+	self->rowsize = size;
+	return 0;
+}
+
+/*	Closes the current row: the values appended since the previous row belong to it. */
+static void
+commit_row(LDAPResultSet *self) {
+	Py_ssize_t i;
+
+	self->nrows++;
+	for (i = 0; i < self->ncolumns; i++) {
+		self->columns[i].rows[self->nrows] = self->columns[i].values.count;
+	}
+}
+
+/*	Adds a new column for the `name` attribute. The previous rows have no value
+	of it. Returns the column, or NULL on error. */
+static LDAPResultColumn *
+add_column(LDAPResultSet *self, PyObject *name) {
+	LDAPResultColumn *tmp, *col;
+
+	if (self->ncolumns == self->colsize) {
+		self->colsize = (self->colsize == 0) ? 16 : self->colsize * 2;
+		tmp = (LDAPResultColumn *)realloc(self->columns, sizeof(LDAPResultColumn) * self->colsize);
+		if (tmp == NULL) {
+			PyErr_NoMemory();
+			return NULL;
+		}
+		self->columns = tmp;
+	}
+	col = &self->columns[self->ncolumns];
+	memset(col, 0, sizeof(LDAPResultColumn));
+	col->str = PyUnicode_AsUTF8AndSize(name, &col->len);
+	if (col->str == NULL) return NULL;
+	col->rows = (Py_ssize_t *)calloc(self->rowsize + 1, sizeof(Py_ssize_t));
+	if (col->rows == NULL) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+	if (buffer_init(&col->values) != 0 || CaseIndex_Insert(&self->index, name) != 0) {
+		free(col->rows);
+		buffer_free(&col->values);
+		return NULL;
+	}
+	Py_INCREF(name);
+	col->name = name;
+	self->ncolumns++;
+	return col;
+}
+
+/*	Returns the column of the attribute, whose name matches case-insensitively
+	the `name`, or NULL if there is no such column. */
+static LDAPResultColumn *
+find_column(LDAPResultSet *self, PyObject *name) {
+	Py_ssize_t i;
+	PyObject *match;
+
+	match = CaseIndex_Lookup(&self->index, name);
+	if (match == NULL) return NULL;
+	for (i = 0; i < self->ncolumns; i++) {
+		if (self->columns[i].name == match) return &self->columns[i];
+	}
+	return NULL;
+}
+
+/*	Returns the column of the `len` long UTF-8 `attr` name, which is the `pos`th
+	attribute of the current entry. The `pos`th column is tried first, then the others,
+	the name is decoded only for a new attribute or a name with different case. */
+static LDAPResultColumn *
+get_column(LDAPResultSet *self, Py_ssize_t pos, const char *attr, Py_ssize_t len) {
+	Py_ssize_t i;
+	PyObject *name;
+	LDAPResultColumn *col;
+
+	if (pos < self->ncolumns && self->columns[pos].len == len
+			&& memcmp(self->columns[pos].str, attr, len) == 0) {
+		return &self->columns[pos];
+	}
+	for (i = 0; i < self->ncolumns; i++) {
+		if (self->columns[i].len == len && memcmp(self->columns[i].str, attr, len) == 0) {
+			return &self->columns[i];
+		}
+	}
+
+	name = PyUnicode_DecodeUTF8(attr, len, NULL);
+	if (name == NULL) return NULL;
+	col = find_column(self, name);
+	if (col == NULL && !PyErr_Occurred()) col = add_column(self, name);
+	Py_DECREF(name);
+	return col;
+}
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+/*	Appends the DN and the values of the `entrymsg` as a new row.
+	The entries without any attribute are skipped. Returns 0 on success, -1 otherwise. */
+int
+LDAPResultSet_AddEntry(LDAPResultSet *self, LDAPMessage *entrymsg) {
+	Py_ssize_t i, pos = 0;
+	char *dn;
+	char *attr = NULL;
+	struct berval **values = NULL;
+	BerElement *ber = NULL;
+	LDAPResultColumn *col;
+
+	if (reserve_row(self) != 0) return -1;
+	dn = ldap_get_dn(self->client->ld, entrymsg);
+	if (buffer_append(&self->dns, dn, (dn != NULL) ? strlen(dn) : 0) != 0) {
+		if (dn != NULL) ldap_memfree(dn);
+		return -1;
+	}
+	if (dn != NULL) ldap_memfree(dn);
+
+	/* Iterate over the LDAP attributes. */
+	for (attr = ldap_first_attribute(self->client->ld, entrymsg, &ber);
+		attr != NULL; attr = ldap_next_attribute(self->client->ld, entrymsg, ber)) {
+		col = get_column(self, pos++, attr, strlen(attr));
+		if (col == NULL) goto Fail;
+		values = ldap_get_values_len(self->client->ld, entrymsg, attr);
+		for (i = 0; values != NULL && values[i] != NULL; i++) {
+			if (buffer_append(&col->values, values[i]->bv_val, values[i]->bv_len) != 0) goto Fail;
+		}
+		if (values != NULL) ldap_value_free_len(values);
+		values = NULL;
+		ldap_memfree(attr);
+	}
+	if (ber != NULL) ber_free(ber, 0);
+
+	if (pos == 0) {
+		/* Remove the DN of the useless entry. */
+		self->dns.count--;
+		self->dns.len = self->dns.offsets[self->dns.count];
+	} else {
+		commit_row(self);
+	}
+	return 0;
+
+Fail:
+	if (values != NULL) ldap_value_free_len(values);
+	if (attr != NULL) ldap_memfree(attr);
+	if (ber != NULL) ber_free(ber, 0);
+	return -1;
+}
+
+#else
+
+/*	Appends the DN and the values of the `entrymsg` as a new row. The values are copied
+	straight from the message's BER buffer. The entries without any attribute are skipped.
+	Returns 0 on success, -1 otherwise. */
+int
+LDAPResultSet_AddEntry(LDAPResultSet *self, LDAPMessage *entrymsg) {
+	int rc;
+	Py_ssize_t i, pos = 0;
+	struct berval dn, attr;
+	struct berval *values = NULL;
+	BerElement *ber = NULL;
+	LDAPResultColumn *col;
+
+	if (reserve_row(self) != 0) return -1;
+	rc = ldap_get_dn_ber(self->client->ld, entrymsg, &ber, &dn);
+	if (rc != LDAP_SUCCESS) goto Error;
+	if (buffer_append(&self->dns, dn.bv_val, dn.bv_len) != 0) goto Fail;
+
+	/* Iterate over the LDAP attributes, `values` is an array of borrowed bervals. */
+	for (rc = ldap_get_attribute_ber(self->client->ld, entrymsg, ber, &attr, &values);
+		rc == LDAP_SUCCESS && attr.bv_val != NULL;
+		rc = ldap_get_attribute_ber(self->client->ld, entrymsg, ber, &attr, &values)) {
+		col = get_column(self, pos++, attr.bv_val, attr.bv_len);
+		if (col == NULL) goto Fail;
+		for (i = 0; values != NULL && values[i].bv_val != NULL; i++) {
+			if (buffer_append(&col->values, values[i].bv_val, values[i].bv_len) != 0) goto Fail;
+		}
+		if (values != NULL) ber_memfree(values);
+		values = NULL;
+	}
+	if (rc != LDAP_SUCCESS) goto Error;
+	ber_free(ber, 0);
+
+	if (pos == 0) {
+		/* Remove the DN of the useless entry. */
+		self->dns.count--;
+		self->dns.len = self->dns.offsets[self->dns.count];
+	} else {
+		commit_row(self);
+	}
+	return 0;
+
+Error:
+	{
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+	}
+Fail:
+	if (values != NULL) ber_memfree(values);
+	if (ber != NULL) ber_free(ber, 0);
+	return -1;
+}
+
+#endif
+
+static Py_ssize_t
+LDAPResultSet_length(LDAPResultSet *self) {
+	return self->nrows;
+}
+
+/*	Returns the `i`th row of the result set. */
+static PyObject *
+LDAPResultSet_item(LDAPResultSet *self, Py_ssize_t i) {
+	LDAPResultRow *row;
+
+	if (i < 0 || i >= self->nrows) {
+		PyErr_SetString(PyExc_IndexError, "LDAPResultSet index out of range.");
+		return NULL;
+	}
+	row = PyObject_New(LDAPResultRow, &LDAPResultRowType);
+	if (row == NULL) return NULL;
+	Py_INCREF(self);
+	row->set = self;
+	row->row = i;
+	return (PyObject *)row;
+}
+
+/*	Returns a read-only memoryview of the `count` items of the `buf` array. */
+static PyObject *
+create_view(LDAPResultSet *self, void *buf, Py_ssize_t count, Py_ssize_t itemsize, char *format) {
+	PyObject *view;
+	LDAPResultBuffer *exporter;
+
+	exporter = PyObject_New(LDAPResultBuffer, &LDAPResultBufferType);
+	if (exporter == NULL) return NULL;
+	Py_INCREF(self);
+	exporter->set = self;
+	exporter->buf = buf;
+	exporter->count = count;
+	exporter->itemsize = itemsize;
+	exporter->format = format;
+	view = PyMemoryView_FromObject((PyObject *)exporter);
+	Py_DECREF(exporter);
+	return view;
+}
+
+/*	Returns the (offsets, data) memoryviews of the `buf`. */
+static PyObject *
+create_buffer_views(LDAPResultSet *self, LDAPValueBuffer *buf) {
+	PyObject *offsets, *data;
+
+	offsets = create_view(self, buf->offsets, buf->count + 1, sizeof(Py_ssize_t), "n");
+	if (offsets == NULL) return NULL;
+	data = create_view(self, buf->data, buf->len, 1, "B");
+	if (data == NULL) {
+		Py_DECREF(offsets);
+		return NULL;
+	}
+	return Py_BuildValue("(NN)", offsets, data);
+}
+
+/*	Returns the (rows, offsets, data) memoryviews of an attribute's values.
+	The values of the `i`th row are the rows[i]..rows[i+1]-1th values, and
+	the `j`th value is data[offsets[j]:offsets[j+1]]. */
+static PyObject *
+LDAPResultSet_column(LDAPResultSet *self, PyObject *name) {
+	PyObject *rows, *bufs, *tuple;
+	LDAPResultColumn *col = NULL;
+
+	if (PyUnicode_Check(name)) col = find_column(self, name);
+	if (col == NULL) {
+		if (!PyErr_Occurred()) {
+			PyErr_Format(PyExc_KeyError, "Attribute '%R' is not in the LDAPResultSet.", name);
+		}
+		return NULL;
+	}
+	rows = create_view(self, col->rows, self->nrows + 1, sizeof(Py_ssize_t), "n");
+	if (rows == NULL) return NULL;
+	bufs = create_buffer_views(self, &col->values);
+	if (bufs == NULL) {
+		Py_DECREF(rows);
+		return NULL;
+	}
+	tuple = Py_BuildValue("(NOO)", rows, PyTuple_GET_ITEM(bufs, 0), PyTuple_GET_ITEM(bufs, 1));
+	Py_DECREF(bufs);
+	return tuple;
+}
+
+/*	Returns the (offsets, data) memoryviews of the rows' DNs. */
+static PyObject *
+LDAPResultSet_dnColumn(LDAPResultSet *self) {
+	return create_buffer_views(self, &self->dns);
+}
+
+static PyObject *
+LDAPResultSet_getAttributes(LDAPResultSet *self, void *closure) {
+	Py_ssize_t i;
+	PyObject *tuple = PyTuple_New(self->ncolumns);
+
+	if (tuple == NULL) return NULL;
+	for (i = 0; i < self->ncolumns; i++) {
+		Py_INCREF(self->columns[i].name);
+		PyTuple_SET_ITEM(tuple, i, self->columns[i].name);
+	}
+	return tuple;
+}
+
+static PyObject *
+LDAPResultSet_getClient(LDAPResultSet *self, void *closure) {
+	if (self->client == NULL) Py_RETURN_NONE;
+	Py_INCREF(self->client);
+	return (PyObject *)self->client;
+}
+
+static PyMethodDef LDAPResultSet_methods[] = {
+	{"column", (PyCFunction)LDAPResultSet_column, METH_O,
+			"Return the (rows, offsets, data) memoryviews of an attribute's values."},
+	{"dn_column", (PyCFunction)LDAPResultSet_dnColumn, METH_NOARGS,
+			"Return the (offsets, data) memoryviews of the DNs."},
+	{NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static PyGetSetDef LDAPResultSet_getsetters[] = {
+	{"attributes",	(getter)LDAPResultSet_getAttributes, NULL,
+					"Tuple of the attributes of the result", NULL},
+	{"client", 		(getter)LDAPResultSet_getClient, NULL,
+					"LDAP client.", NULL},
+	{NULL}  /* Sentinel */
+};
+
+static PySequenceMethods LDAPResultSet_sequence_meths = {
+	(lenfunc)LDAPResultSet_length,		/* sq_length */
+	0,									/* sq_concat */
+	0,									/* sq_repeat */
+	(ssizeargfunc)LDAPResultSet_item,	/* sq_item */
+};
+
+PyTypeObject LDAPResultSetType = {
+	PyObject_HEAD_INIT(NULL)
+	"pyLDAP.LDAPResultSet",		/* tp_name */
+	sizeof(LDAPResultSet),		/* tp_basicsize */
+	0,							/* tp_itemsize */
+	(destructor)LDAPResultSet_dealloc, /* tp_dealloc */
+	0,							/* tp_print */
+	0,							/* tp_getattr */
+	0,							/* tp_setattr */
+	0,							/* tp_reserved */
+	0,							/* tp_repr */
+	0,							/* tp_as_number */
+	&LDAPResultSet_sequence_meths, /* tp_as_sequence */
+	0,							/* tp_as_mapping */
+	0,							/* tp_hash */
+	0,							/* tp_call */
+	0,							/* tp_str */
+	0,							/* tp_getattro */
+	0,							/* tp_setattro */
+	0,							/* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC, /* tp_flags */
+	"Columnar result of a search.", /* tp_doc */
+	(traverseproc)LDAPResultSet_traverse, /* tp_traverse */
+	(inquiry)LDAPResultSet_clear, /* tp_clear */
+	0,							/* tp_richcompare */
+	0,							/* tp_weaklistoffset */
+	0,							/* tp_iter */
+	0,							/* tp_iternext */
+	LDAPResultSet_methods,		/* tp_methods */
+	0,							/* tp_members */
+	LDAPResultSet_getsetters,	/* tp_getset */
+};
+
+/*	Deallocate the LDAPResultRow. */
+static void
+LDAPResultRow_dealloc(LDAPResultRow *self) {
+	Py_DECREF(self->set);
+	PyObject_Del(self);
+}
+
+/*	Returns the number of the row's values in the `col` column. */
+#define ROW_VALUES(col, row) ((col)->rows[(row) + 1] - (col)->rows[(row)])
+
+/*	Creates a tuple of the row's values in the `col` column,
+	converted by the decoding policy of the attribute. */
+static PyObject *
+create_values(LDAPResultRow *self, LDAPResultColumn *col) {
+	int policy;
+	Py_ssize_t i, first;
+	struct berval bval;
+	PyObject *val;
+	PyObject *tuple = PyTuple_New(ROW_VALUES(col, self->row));
+	LDAPClient *client = self->set->client;
+
+	if (tuple == NULL) return NULL;
+	policy = LDAPClient_DecodePolicy(client, col->str, col->len);
+	first = col->rows[self->row];
+	for (i = 0; i < PyTuple_GET_SIZE(tuple); i++) {
+		bval.bv_val = col->values.data + col->values.offsets[first + i];
+		bval.bv_len = col->values.offsets[first + i + 1] - col->values.offsets[first + i];
+		val = LDAPClient_DecodeValue(client, &bval, policy);
+		if (val == NULL) {
+			Py_DECREF(tuple);
+			return NULL;
+		}
+		PyTuple_SET_ITEM(tuple, i, val);
+	}
+	return tuple;
+}
+
+/*	Return the values of the attribute, whose name has a case-insensitive
+	match with the `key`, as a tuple. */
+static PyObject *
+LDAPResultRow_subscript(LDAPResultRow *self, PyObject *key) {
+	LDAPResultColumn *col = NULL;
+
+	if (PyUnicode_Check(key)) col = find_column(self->set, key);
+	if (col == NULL || ROW_VALUES(col, self->row) == 0) {
+		if (!PyErr_Occurred()) {
+			PyErr_Format(PyExc_KeyError, "Key '%R' is not in the LDAPResultRow.", key);
+		}
+		return NULL;
+	}
+	return create_values(self, col);
+}
+
+static int
+LDAPResultRow_contains(LDAPResultRow *self, PyObject *key) {
+	LDAPResultColumn *col = NULL;
+
+	if (PyUnicode_Check(key)) col = find_column(self->set, key);
+	if (col == NULL) return PyErr_Occurred() ? -1 : 0;
+	return ROW_VALUES(col, self->row) > 0;
+}
+
+static Py_ssize_t
+LDAPResultRow_length(LDAPResultRow *self) {
+	Py_ssize_t i, len = 0;
+
+	for (i = 0; i < self->set->ncolumns; i++) {
+		if (ROW_VALUES(&self->set->columns[i], self->row) > 0) len++;
+	}
+	return len;
+}
+
+/* Returns the list of the attributes, which have values in the row. */
+static PyObject *
+LDAPResultRow_keys(LDAPResultRow *self) {
+	Py_ssize_t i;
+	PyObject *list = PyList_New(0);
+
+	if (list == NULL) return NULL;
+	for (i = 0; i < self->set->ncolumns; i++) {
+		if (ROW_VALUES(&self->set->columns[i], self->row) > 0
+				&& PyList_Append(list, self->set->columns[i].name) != 0) {
+			Py_DECREF(list);
+			return NULL;
+		}
+	}
+	return list;
+}
+
+static PyObject *
+LDAPResultRow_iter(LDAPResultRow *self) {
+	PyObject *iter;
+	PyObject *keys = LDAPResultRow_keys(self);
+
+	if (keys == NULL) return NULL;
+	iter = PyObject_GetIter(keys);
+	Py_DECREF(keys);
+	return iter;
+}
+
+static PyObject *
+LDAPResultRow_getDN(LDAPResultRow *self, void *closure) {
+	LDAPValueBuffer *dns = &self->set->dns;
+
+	return PyUnicode_DecodeUTF8(dns->data + dns->offsets[self->row],
+			dns->offsets[self->row + 1] - dns->offsets[self->row], NULL);
+}
+
+/*	Returns a mutable LDAPEntry with the same DN and values, which can be modified
+	and sent to the server. */
+static PyObject *
+LDAPResultRow_toEntry(LDAPResultRow *self) {
+	Py_ssize_t i;
+	const char *dnstr;
+	PyObject *dn, *values;
+	LDAPResultColumn *col;
+	LDAPEntry *entry;
+
+	entry = LDAPEntry_New();
+	if (entry == NULL) return NULL;
+	if (LDAPEntry_SetClient(entry, self->set->client) != 0) goto Fail;
+	dn = LDAPResultRow_getDN(self, NULL);
+	if (dn == NULL) goto Fail;
+	dnstr = PyUnicode_AsUTF8(dn);
+	if (dnstr == NULL || LDAPEntry_SetStringDN(entry, (char *)dnstr) != 0) {
+		Py_DECREF(dn);
+		goto Fail;
+	}
+	Py_DECREF(dn);
+	for (i = 0; i < self->set->ncolumns; i++) {
+		col = &self->set->columns[i];
+		if (ROW_VALUES(col, self->row) == 0) continue;
+		values = create_values(self, col);
+		if (values == NULL) goto Fail;
+		if (LDAPEntry_AddReceived(entry, col->name, values) != 0) {
+			Py_DECREF(values);
+			goto Fail;
+		}
+		Py_DECREF(values);
+	}
+	return (PyObject *)entry;
+
+Fail:
+	Py_DECREF(entry);
+	return NULL;
+}
+
+static PyMethodDef LDAPResultRow_methods[] = {
+	{"keys", (PyCFunction)LDAPResultRow_keys, METH_NOARGS,
+			"Return the list of the row's attributes."},
+	{"to_entry", (PyCFunction)LDAPResultRow_toEntry, METH_NOARGS,
+			"Return a mutable LDAPEntry with the same DN and values."},
+	{NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+static PyGetSetDef LDAPResultRow_getsetters[] = {
+	{"dn", 			(getter)LDAPResultRow_getDN, NULL,
+					"Distinguished name (string)", NULL},
+	{NULL}  /* Sentinel */
+};
+
+static PySequenceMethods LDAPResultRow_sequence_meths = {
+	0,									/* sq_length */
+	0,									/* sq_concat */
+	0,									/* sq_repeat */
+	0,									/* sq_item */
+	0,									/* sq_slice */
+	0,									/* sq_ass_item */
+	0,									/* sq_ass_slice */
+	(objobjproc)LDAPResultRow_contains,	/* sq_contains */
+};
+
+static PyMappingMethods LDAPResultRow_mapping_meths = {
+	(lenfunc)LDAPResultRow_length,			/* mp_length */
+	(binaryfunc)LDAPResultRow_subscript,	/* mp_subscript */
+	0,										/* mp_ass_subscript */
+};
+
+PyTypeObject LDAPResultRowType = {
+	PyObject_HEAD_INIT(NULL)
+	"pyLDAP.LDAPResultRow",		/* tp_name */
+	sizeof(LDAPResultRow),		/* tp_basicsize */
+	0,							/* tp_itemsize */
+	(destructor)LDAPResultRow_dealloc, /* tp_dealloc */
+	0,							/* tp_print */
+	0,							/* tp_getattr */
+	0,							/* tp_setattr */
+	0,							/* tp_reserved */
+	0,							/* tp_repr */
+	0,							/* tp_as_number */
+	&LDAPResultRow_sequence_meths, /* tp_as_sequence */
+	&LDAPResultRow_mapping_meths, /* tp_as_mapping */
+	0,							/* tp_hash */
+	0,							/* tp_call */
+	0,							/* tp_str */
+	0,							/* tp_getattro */
+	0,							/* tp_setattro */
+	0,							/* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,			/* tp_flags */
+	"Read-only row of an LDAPResultSet.", /* tp_doc */
+	0,							/* tp_traverse */
+	0,							/* tp_clear */
+	0,							/* tp_richcompare */
+	0,							/* tp_weaklistoffset */
+	(getiterfunc)LDAPResultRow_iter, /* tp_iter */
+	0,							/* tp_iternext */
+	LDAPResultRow_methods,		/* tp_methods */
+	0,							/* tp_members */
+	LDAPResultRow_getsetters,	/* tp_getset */
+};
+
+/*	Deallocate the LDAPResultBuffer. */
+static void
+LDAPResultBuffer_dealloc(LDAPResultBuffer *self) {
+	Py_DECREF(self->set);
+	PyObject_Del(self);
+}
+
+/*	Fills the `view` with the read-only, one-dimensional array of the exporter.
+	The LDAPResultSet is not changed after it has been returned, so the array
+	is valid as long as the exporter is alive. */
+static int
+LDAPResultBuffer_getbuffer(LDAPResultBuffer *self, Py_buffer *view, int flags) {
+	static char empty[1];
+
+	if (flags & PyBUF_WRITABLE) {
+		PyErr_SetString(PyExc_BufferError, "LDAPResultSet's buffers are read-only.");
+		view->obj = NULL;
+		return -1;
+	}
+	view->buf = (self->buf != NULL) ? self->buf : empty;
+	Py_INCREF(self);
+	view->obj = (PyObject *)self;
+	view->len = self->count * self->itemsize;
+	view->readonly = 1;
+	view->itemsize = self->itemsize;
+	view->format = (flags & PyBUF_FORMAT) ? self->format : NULL;
+	view->ndim = 1;
+	view->shape = (flags & PyBUF_ND) ? &self->count : NULL;
+	view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &self->itemsize : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	return 0;
+}
+
+static PyBufferProcs LDAPResultBuffer_buffer_procs = {
+	(getbufferproc)LDAPResultBuffer_getbuffer,	/* bf_getbuffer */
+	0,											/* bf_releasebuffer */
+};
+
+PyTypeObject LDAPResultBufferType = {
+	PyObject_HEAD_INIT(NULL)
+	"pyLDAP.LDAPResultBuffer",	/* tp_name */
+	sizeof(LDAPResultBuffer),	/* tp_basicsize */
+	0,							/* tp_itemsize */
+	(destructor)LDAPResultBuffer_dealloc, /* tp_dealloc */
+	0,							/* tp_print */
+	0,							/* tp_getattr */
+	0,							/* tp_setattr */
+	0,							/* tp_reserved */
+	0,							/* tp_repr */
+	0,							/* tp_as_number */
+	0,							/* tp_as_sequence */
+	0,							/* tp_as_mapping */
+	0,							/* tp_hash */
+	0,							/* tp_call */
+	0,							/* tp_str */
+	0,							/* tp_getattro */
+	0,							/* tp_setattro */
+	&LDAPResultBuffer_buffer_procs, /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,			/* tp_flags */
+	"Buffer of an LDAPResultSet.", /* tp_doc */
+};
@@ -0,0 +1,82 @@
+#ifndef LDAPRESULTSET_H_
+#define LDAPRESULTSET_H_
+
+#include <Python.h>
+#include "structmember.h"
+
+//MS Windows
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+#include <windows.h>
+#include <winldap.h>
+
+//Unix
+#else
+#include <ldap.h>
+
+#endif
+
+#include "ldapclient.h"
+#include "caseindex.h"
+
+/*	Raw values stored one after the other in the `data` buffer,
+	the `i`th value is data[offsets[i]:offsets[i+1]]. */
+typedef struct {
+	char *data;
+	Py_ssize_t len;
+	Py_ssize_t size;
+	Py_ssize_t *offsets;
+	Py_ssize_t count;
+	Py_ssize_t osize;
+} LDAPValueBuffer;
+
+/*	The values of an attribute. The values of the `i`th row are
+	the rows[i]..rows[i+1]-1th values of the buffer. */
+typedef struct {
+	PyObject *name;
+	const char *str;
+	Py_ssize_t len;
+	Py_ssize_t *rows;
+	LDAPValueBuffer values;
+} LDAPResultColumn;
+
+/*	Columnar result of a search: the DNs and the values of every attribute
+	are stored in contiguous buffers, without creating any Python object
+	for the entries. The rows are decoded only when they are accessed. */
+typedef struct {
+	PyObject_HEAD
+	LDAPClient *client;
+	Py_ssize_t nrows;
+	Py_ssize_t rowsize;
+	LDAPValueBuffer dns;
+	LDAPResultColumn *columns;
+	Py_ssize_t ncolumns;
+	Py_ssize_t colsize;
+	CaseIndex index;
+} LDAPResultSet;
+
+/* A row of an LDAPResultSet, a read-only view of an entry. */
+typedef struct {
+	PyObject_HEAD
+	LDAPResultSet *set;
+	Py_ssize_t row;
+} LDAPResultRow;
+
+/* Exports a part of an LDAPResultSet through the buffer protocol. */
+typedef struct {
+	PyObject_HEAD
+	LDAPResultSet *set;
+	void *buf;
+	Py_ssize_t count;
+	Py_ssize_t itemsize;
+	char *format;
+} LDAPResultBuffer;
+
+extern PyTypeObject LDAPResultSetType;
+extern PyTypeObject LDAPResultRowType;
+extern PyTypeObject LDAPResultBufferType;
+
+LDAPResultSet *LDAPResultSet_New(LDAPClient *client);
+int LDAPResultSet_AddEntry(LDAPResultSet *self, LDAPMessage *entrymsg);
+
+#endif /* LDAPRESULTSET_H_ */
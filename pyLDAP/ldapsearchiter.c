@@ -0,0 +1,393 @@
+#include "ldapsearchiter.h"
+#include "ldapentry.h"
+#include "utils.h"
+
+/*	Dealloc the LDAPSearchIter object. The still running page request is abandoned. */
+static void
+LDAPSearchIter_dealloc(LDAPSearchIter *self) {
+	if (self->msgid != -1 && self->client != NULL && self->client->connected) {
+		ldap_abandon_ext(self->client->ld, self->msgid, NULL, NULL);
+	}
+	if (self->res != NULL) ldap_msgfree(self->res);
+	Py_XDECREF(self->resowner);
+	Py_XDECREF(self->layout);
+	free(self->base);
+	free(self->filter);
+	free_string_list(self->attrs);
+	Py_XDECREF(self->client);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/*	Sends the search request of the next page with the `cookie` of the previous page's
+	response (or NULL for the first page). If the page size is 0, the request is sent
+	without paged results control. Returns 0 on success, -1 otherwise. */
+static int
+send_page_request(LDAPSearchIter *self, struct berval *cookie) {
+	int rc = LDAP_SUCCESS;
+	struct timeval timelimit;
+	struct timeval *timelimitp = NULL;
+	struct berval empty = {0, NULL};
+	LDAPControl *page_ctrl = NULL;
+	LDAPControl *server_ctrls[2] = {NULL, NULL};
+
+	if (self->timeout > 0) {
+		timelimit.tv_sec = self->timeout;
+		timelimit.tv_usec = 0;
+		timelimitp = &timelimit;
+	}
+	if (cookie == NULL) cookie = &empty;
+
+	/* The control is created with the handle, so it is checked first. */
+	LDAPCLIENT_BEGIN_CALL(self->client, { self->msgid = -1; return -1; })
+	if (self->page_size > 0) {
+		rc = _LDAP_create_page_control(self->client->ld, self->page_size, cookie, &page_ctrl);
+		server_ctrls[0] = page_ctrl;
+	}
+	if (rc == LDAP_SUCCESS) {
+		rc = ldap_search_ext(self->client->ld, self->base, self->scope, self->filter, self->attrs,
+				self->attrsonly, server_ctrls, NULL, timelimitp, self->sizelimit, &(self->msgid));
+	}
+	LDAPCLIENT_END_CALL(self->client)
+	if (page_ctrl != NULL) ldap_control_free(page_ctrl);
+
+	if (rc != LDAP_SUCCESS) {
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		self->msgid = -1;
+		return -1;
+	}
+	return 0;
+}
+
+/*	Waits for the whole current page, then sends the request of the next page
+	(if there is any) before the entries of the current one are processed.
+	Returns 0 on success, -1 otherwise.
+*/
+static int
+receive_page(LDAPSearchIter *self) {
+	int rc, err = LDAP_SUCCESS;
+	struct timeval timelimit;
+	struct timeval *timelimitp = NULL;
+	struct berval *cookie = NULL;
+	LDAPControl **server_ctrls = NULL;
+
+	if (self->timeout > 0) {
+		timelimit.tv_sec = self->timeout;
+		timelimit.tv_usec = 0;
+		timelimitp = &timelimit;
+	}
+
+	LDAPCLIENT_BEGIN_CALL(self->client, { self->msgid = -1; return -1; })
+	rc = ldap_result(self->client->ld, self->msgid, LDAP_MSG_ALL, timelimitp, &(self->res));
+	LDAPCLIENT_END_CALL(self->client)
+
+	if (rc <= 0) {
+		if (rc == 0) {
+			ldap_abandon_ext(self->client->ld, self->msgid, NULL, NULL);
+			rc = LDAP_TIMEOUT;
+		} else {
+			ldap_get_option(self->client->ld, LDAP_OPT_RESULT_CODE, &rc);
+		}
+		self->msgid = -1;
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return -1;
+	}
+	self->msgid = -1;
+
+	rc = ldap_parse_result(self->client->ld, self->res, &err, NULL, NULL, NULL, &server_ctrls, 0);
+	if (rc == LDAP_SUCCESS) rc = err;
+	if (rc == LDAP_NO_SUCH_OBJECT) {
+		if (server_ctrls != NULL) ldap_controls_free(server_ctrls);
+		return 0;
+	}
+	if (rc != LDAP_SUCCESS) {
+		if (server_ctrls != NULL) ldap_controls_free(server_ctrls);
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return -1;
+	}
+
+	/* Request the next page, if the server sent a non-empty cookie. */
+	if (server_ctrls != NULL) {
+		_LDAP_parse_page_control(self->client->ld, server_ctrls, &cookie);
+		ldap_controls_free(server_ctrls);
+	}
+	if (cookie != NULL) {
+		if (cookie->bv_len > 0 && send_page_request(self, cookie) != 0) {
+			ber_bvfree(cookie);
+			return -1;
+		}
+		ber_bvfree(cookie);
+	}
+
+	self->entry = ldap_first_entry(self->client->ld, self->res);
+	return 0;
+}
+
+/*	Gets the rest of the values of the entry's attributes, which are received in ranges.
+	Returns the entry, or NULL (and the entry is released) if it's failed. */
+static PyObject *
+complete_entry(LDAPSearchIter *self, PyObject *entryobj) {
+	if (!(self->flags & _LDAP_ENTRY_FROZEN) && LDAPEntry_FetchRanges(self->client, entryobj) != 0) {
+		Py_DECREF(entryobj);
+		return NULL;
+	}
+	return entryobj;
+}
+
+/*	Receives the messages of a non-paged search one by one, and returns the next LDAPEntry
+	as soon as it is arrived. Returns NULL without exception, when the search is done. */
+static PyObject *
+receive_entry(LDAPSearchIter *self) {
+	int rc, err = LDAP_SUCCESS;
+	struct timeval timelimit;
+	struct timeval *timelimitp = NULL;
+	LDAPMessage *msg = NULL;
+	PyObject *msgowner = NULL;
+	PyObject *entryobj;
+
+	if (self->timeout > 0) {
+		timelimit.tv_sec = self->timeout;
+		timelimit.tv_usec = 0;
+		timelimitp = &timelimit;
+	}
+
+	while (self->msgid != -1) {
+		LDAPCLIENT_BEGIN_CALL(self->client, { self->msgid = -1; return NULL; })
+		rc = ldap_result(self->client->ld, self->msgid, LDAP_MSG_ONE, timelimitp, &msg);
+		LDAPCLIENT_END_CALL(self->client)
+
+		switch (rc) {
+		case LDAP_RES_SEARCH_ENTRY:
+			if (self->flags & _LDAP_ENTRY_LAZY) {
+				/* The lazy entry keeps its message alive. */
+				msgowner = LDAPMessage2PyCapsule(msg);
+				if (msgowner == NULL) return NULL;
+				entryobj = LDAPEntry_Create(msg, self->client, self->flags, msgowner, self->layout);
+				Py_DECREF(msgowner);
+			} else {
+				entryobj = LDAPEntry_Create(msg, self->client, self->flags, NULL, self->layout);
+				ldap_msgfree(msg);
+			}
+			if (entryobj == NULL) return NULL;
+			/* Skip useless LDAPEntry. */
+			if (entryobj == Py_None) {
+				Py_DECREF(entryobj);
+				continue;
+			}
+			return complete_entry(self, entryobj);
+		case LDAP_RES_SEARCH_REFERENCE:
+			ldap_msgfree(msg);
+			continue;
+		case LDAP_RES_SEARCH_RESULT:
+			self->msgid = -1;
+			rc = ldap_parse_result(self->client->ld, msg, &err, NULL, NULL, NULL, NULL, 1);
+			if (rc == LDAP_SUCCESS) rc = err;
+			if (rc == LDAP_SUCCESS || rc == LDAP_NO_SUCH_OBJECT) return NULL;
+			break;
+		case 0:
+			ldap_abandon_ext(self->client->ld, self->msgid, NULL, NULL);
+			self->msgid = -1;
+			rc = LDAP_TIMEOUT;
+			break;
+		default:
+			if (msg != NULL) ldap_msgfree(msg);
+			if (rc > 0) continue;
+			ldap_get_option(self->client->ld, LDAP_OPT_RESULT_CODE, &rc);
+			self->msgid = -1;
+		}
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return NULL;
+	}
+	return NULL;
+}
+
+/*	Returns the next LDAPEntry of the result. The current page is freed,
+	when all of its entries are processed. */
+static PyObject *
+LDAPSearchIter_iternext(LDAPSearchIter *self) {
+	PyObject *entryobj;
+
+	if (self->page_size == 0) {
+		if (self->msgid == -1) return NULL;
+		if (!self->client->connected) {
+			PyObject *ldaperror = get_error("NotConnected");
+			PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+			Py_DECREF(ldaperror);
+			return NULL;
+		}
+		return receive_entry(self);
+	}
+
+	while (1) {
+		while (self->entry != NULL) {
+			entryobj = LDAPEntry_Create(self->entry, self->client, self->flags, self->resowner,
+					self->layout);
+			self->entry = ldap_next_entry(self->client->ld, self->entry);
+			if (entryobj == NULL) return NULL;
+			/* Skip useless LDAPEntry. */
+			if (entryobj == Py_None) {
+				Py_DECREF(entryobj);
+				continue;
+			}
+			return complete_entry(self, entryobj);
+		}
+		if (self->res != NULL) {
+			ldap_msgfree(self->res);
+			self->res = NULL;
+		}
+		Py_CLEAR(self->resowner);
+		/* There is no more page. */
+		if (self->msgid == -1) return NULL;
+
+		if (!self->client->connected) {
+			PyObject *ldaperror = get_error("NotConnected");
+			PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+			Py_DECREF(ldaperror);
+			return NULL;
+		}
+		if (receive_page(self) != 0) return NULL;
+		if ((self->flags & _LDAP_ENTRY_LAZY) && self->res != NULL) {
+			/* The page is freed, when its every lazy entry is released. */
+			self->resowner = LDAPMessage2PyCapsule(self->res);
+			self->res = NULL;
+			if (self->resowner == NULL) {
+				self->entry = NULL;
+				return NULL;
+			}
+		}
+	}
+}
+
+/*	Stop the search. The running request is abandoned, so the server stops sending the entries. */
+static PyObject *
+LDAPSearchIter_close(LDAPSearchIter *self) {
+	if (self->msgid != -1 && self->client->connected) {
+		ldap_abandon_ext(self->client->ld, self->msgid, NULL, NULL);
+	}
+	self->msgid = -1;
+	self->entry = NULL;
+	if (self->res != NULL) {
+		ldap_msgfree(self->res);
+		self->res = NULL;
+	}
+	Py_CLEAR(self->resowner);
+	Py_RETURN_NONE;
+}
+
+static PyMethodDef LDAPSearchIter_methods[] = {
+	{"close", (PyCFunction)LDAPSearchIter_close, METH_NOARGS,
+	 "Stop the search and abandon the running request."
+	},
+	{NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+/*	Create a new LDAPSearchIter for internal use and send the request of the first page.
+	The iterator takes the ownership of the `attrs` list, the `base` and `filter` strings are copied.
+	The `flags` are passed to the created LDAPEntries.
+*/
+LDAPSearchIter *
+LDAPSearchIter_New(LDAPClient *client, char *base, int scope, char *filter, char **attrs,
+		int attrsonly, int timeout, int sizelimit, int page_size, int flags) {
+	LDAPSearchIter *self;
+
+	self = (LDAPSearchIter *)LDAPSearchIterType.tp_alloc(&LDAPSearchIterType, 0);
+	if (self == NULL) {
+		free_string_list(attrs);
+		return (LDAPSearchIter *)PyErr_NoMemory();
+	}
+	Py_INCREF(client);
+	self->client = client;
+	self->attrs = attrs;
+	self->scope = scope;
+	self->attrsonly = attrsonly;
+	self->timeout = timeout;
+	self->sizelimit = sizelimit;
+	self->page_size = page_size;
+	self->flags = flags;
+	self->msgid = -1;
+	self->res = NULL;
+	self->resowner = NULL;
+	self->entry = NULL;
+	/* The entries of every page share the attributes' names. */
+	self->layout = AttrLayout_New();
+	if (self->layout == NULL) {
+		Py_DECREF(self);
+		return NULL;
+	}
+
+	/* If empty filter string is given, leave it NULL. */
+	if (filter != NULL && strlen(filter) > 0) {
+		self->filter = strdup(filter);
+		if (self->filter == NULL) {
+			Py_DECREF(self);
+			return (LDAPSearchIter *)PyErr_NoMemory();
+		}
+	}
+	self->base = strdup(base);
+	if (self->base == NULL) {
+		Py_DECREF(self);
+		return (LDAPSearchIter *)PyErr_NoMemory();
+	}
+
+	if (send_page_request(self, NULL) != 0) {
+		Py_DECREF(self);
+		return NULL;
+	}
+	return self;
+}
+
+PyTypeObject LDAPSearchIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pyLDAP.LDAPSearchIter",   /* tp_name */
+    sizeof(LDAPSearchIter),    /* tp_basicsize */
+    0,                         /* tp_itemsize */
+    (destructor)LDAPSearchIter_dealloc, /* tp_dealloc */
+    0,                         /* tp_print */
+    0,                         /* tp_getattr */
+    0,                         /* tp_setattr */
+    0,                         /* tp_reserved */
+    0,                         /* tp_repr */
+    0,                         /* tp_as_number */
+    0,                         /* tp_as_sequence */
+    0,                         /* tp_as_mapping */
+    0,                         /* tp_hash  */
+    0,                         /* tp_call */
+    0,                         /* tp_str */
+    0,                         /* tp_getattro */
+    0,                         /* tp_setattro */
+    0,                         /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,        /* tp_flags */
+    "LDAPSearchIter object",   /* tp_doc */
+    0,                         /* tp_traverse */
+    0,                         /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,                         /* tp_weaklistoffset */
+    PyObject_SelfIter,         /* tp_iter */
+    (iternextfunc)LDAPSearchIter_iternext, /* tp_iternext */
+    LDAPSearchIter_methods,    /* tp_methods */
+    0,                         /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
@@ -0,0 +1,46 @@
+#ifndef LDAPSEARCHITER_H_
+#define LDAPSEARCHITER_H_
+
+#include <Python.h>
+#include "structmember.h"
+
+//MS Windows
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+#include <windows.h>
+#include <winldap.h>
+
+//Unix
+#else
+#include <ldap.h>
+
+#endif
+
+#include "ldapclient.h"
+#include "attrlayout.h"
+
+typedef struct {
+	PyObject_HEAD
+	LDAPClient *client;
+	char *base;
+	char *filter;
+	char **attrs;
+	int scope;
+	int attrsonly;
+	int timeout;
+	int sizelimit;
+	int page_size;
+	int flags;
+	int msgid;
+	LDAPMessage *res;
+	PyObject *resowner;
+	AttrLayout *layout;
+	LDAPMessage *entry;
+} LDAPSearchIter;
+
+extern PyTypeObject LDAPSearchIterType;
+
+LDAPSearchIter *LDAPSearchIter_New(LDAPClient *client, char *base, int scope, char *filter, char **attrs,
+		int attrsonly, int timeout, int sizelimit, int page_size, int flags);
+
+#endif /* LDAPSEARCHITER_H_ */
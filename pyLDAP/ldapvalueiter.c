@@ -0,0 +1,290 @@
+#include "ldapvalueiter.h"
+#include "utils.h"
+
+/*	Dealloc the LDAPValueIter object. The still running range request is abandoned. */
+static void
+LDAPValueIter_dealloc(LDAPValueIter *self) {
+	if (self->msgid != -1 && self->client != NULL && self->client->connected) {
+		ldap_abandon_ext(self->client->ld, self->msgid, NULL, NULL);
+	}
+	free(self->dn);
+	Py_XDECREF(self->name);
+	Py_XDECREF(self->values);
+	Py_XDECREF(self->client);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/*	Sends the base search request for the values of the attribute from the `next` index.
+	The first range is requested by the plain name, so the servers without ranged
+	retrieval simply send every value. Returns 0 on success, -1 otherwise. */
+static int
+send_range_request(LDAPValueIter *self) {
+	int rc;
+	char filter[] = "(objectClass=*)";
+	char *attrs[2] = {NULL, NULL};
+	PyObject *attr;
+
+	if (self->next == 0) {
+		attr = self->name;
+		Py_INCREF(attr);
+	} else {
+		attr = PyUnicode_FromFormat("%U;range=%zd-*", self->name, self->next);
+		if (attr == NULL) return -1;
+	}
+	attrs[0] = (char *)PyUnicode_AsUTF8(attr);
+	if (attrs[0] == NULL) {
+		Py_DECREF(attr);
+		return -1;
+	}
+
+	LDAPCLIENT_BEGIN_CALL(self->client, {
+		Py_DECREF(attr);
+		self->msgid = -1;
+		return -1;
+	})
+	rc = ldap_search_ext(self->client->ld, self->dn, LDAP_SCOPE_BASE, filter, attrs, 0,
+			NULL, NULL, NULL, 0, &(self->msgid));
+	LDAPCLIENT_END_CALL(self->client)
+	Py_DECREF(attr);
+
+	if (rc != LDAP_SUCCESS) {
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		self->msgid = -1;
+		return -1;
+	}
+	return 0;
+}
+
+/*	Decodes the values of the entry's attribute, which matches the iterator's attribute
+	with or without a range option, into a new `values` list. Sets the first index of
+	the following range (-1 if there is none). Returns 0 on success, -1 otherwise. */
+static int
+decode_range(LDAPValueIter *self, LDAPMessage *entry) {
+	int i, rc = 0;
+	Py_ssize_t len, namelen, next = -1;
+	const char *name;
+	char *attr;
+	struct berval **values = NULL;
+	BerElement *ber = NULL;
+	PyObject *val;
+
+	name = PyUnicode_AsUTF8AndSize(self->name, &namelen);
+	if (name == NULL) return -1;
+	self->values = PyList_New(0);
+	if (self->values == NULL) return -1;
+
+	for (attr = ldap_first_attribute(self->client->ld, entry, &ber);
+		attr != NULL; attr = ldap_next_attribute(self->client->ld, entry, ber)) {
+		len = parse_attr_range(attr, strlen(attr), &next);
+		if (len == -1) {
+			len = strlen(attr);
+			next = -1;
+		}
+		if (len == namelen && asciiCaseEqual(attr, name, len)) break;
+		ldap_memfree(attr);
+		next = -1;
+	}
+	if (attr != NULL) {
+		values = ldap_get_values_len(self->client->ld, entry, attr);
+		for (i = 0; rc == 0 && values != NULL && values[i] != NULL; i++) {
+			val = LDAPClient_DecodeValue(self->client, values[i], self->policy);
+			if (val == NULL) {
+				rc = -1;
+				break;
+			}
+			rc = PyList_Append(self->values, val);
+			Py_DECREF(val);
+		}
+		if (values != NULL) ldap_value_free_len(values);
+		ldap_memfree(attr);
+	}
+	if (ber != NULL) ber_free(ber, 0);
+	/* Stop, if the server would send the same range again. */
+	if (next != -1 && next <= self->next) next = -1;
+	self->next = next;
+	return rc;
+}
+
+/*	Waits for the response of the running range request, and decodes its values. The request
+	of the following range (if there is any) is sent before the values are processed by the
+	caller. Returns 0 on success, -1 otherwise. */
+static int
+receive_range(LDAPValueIter *self) {
+	int rc, err = LDAP_SUCCESS;
+	LDAPMessage *res = NULL;
+	LDAPMessage *entry;
+
+	LDAPCLIENT_BEGIN_CALL(self->client, { self->msgid = -1; return -1; })
+	rc = ldap_result(self->client->ld, self->msgid, LDAP_MSG_ALL, NULL, &res);
+	LDAPCLIENT_END_CALL(self->client)
+	self->msgid = -1;
+
+	if (rc <= 0) {
+		ldap_get_option(self->client->ld, LDAP_OPT_RESULT_CODE, &rc);
+	} else {
+		rc = ldap_parse_result(self->client->ld, res, &err, NULL, NULL, NULL, NULL, 0);
+		if (rc == LDAP_SUCCESS) rc = err;
+	}
+	if (rc == LDAP_NO_SUCH_OBJECT) {
+		ldap_msgfree(res);
+		self->next = -1;
+		return 0;
+	}
+	if (rc != LDAP_SUCCESS) {
+		if (res != NULL) ldap_msgfree(res);
+		PyObject *ldaperror = get_error_by_code(rc);
+		if (ldaperror != NULL) {
+			PyErr_SetString(ldaperror, ldap_err2string(rc));
+			Py_DECREF(ldaperror);
+		}
+		return -1;
+	}
+
+	entry = ldap_first_entry(self->client->ld, res);
+	if (entry == NULL) {
+		self->next = -1;
+	} else if (decode_range(self, entry) != 0) {
+		ldap_msgfree(res);
+		return -1;
+	}
+	ldap_msgfree(res);
+	if (self->next != -1) return send_range_request(self);
+	return 0;
+}
+
+/*	Returns a list of the values of the next range. The values of the current range
+	are dropped. Returns NULL without exception, when there is no more range. */
+PyObject *
+LDAPValueIter_NextRange(LDAPValueIter *self) {
+	PyObject *values;
+
+	Py_CLEAR(self->values);
+	self->pos = 0;
+	if (self->msgid == -1) return NULL;
+	if (!self->client->connected) {
+		PyObject *ldaperror = get_error("NotConnected");
+		PyErr_SetString(ldaperror, "Client has to connect to the server first.");
+		Py_DECREF(ldaperror);
+		return NULL;
+	}
+	if (receive_range(self) != 0 || self->values == NULL) return NULL;
+	values = self->values;
+	Py_INCREF(values);
+	return values;
+}
+
+/*	Returns the next value. The next range is received, when every value of the
+	current one is returned. */
+static PyObject *
+LDAPValueIter_iternext(LDAPValueIter *self) {
+	PyObject *item, *values;
+
+	while (self->values == NULL || self->pos >= PyList_GET_SIZE(self->values)) {
+		values = LDAPValueIter_NextRange(self);
+		if (values == NULL) return NULL;
+		Py_DECREF(values);
+	}
+	item = PyList_GET_ITEM(self->values, self->pos++);
+	Py_INCREF(item);
+	return item;
+}
+
+/*	Stop the iteration. The running request is abandoned. */
+static PyObject *
+LDAPValueIter_close(LDAPValueIter *self) {
+	if (self->msgid != -1 && self->client->connected) {
+		ldap_abandon_ext(self->client->ld, self->msgid, NULL, NULL);
+	}
+	self->msgid = -1;
+	Py_CLEAR(self->values);
+	Py_RETURN_NONE;
+}
+
+static PyMethodDef LDAPValueIter_methods[] = {
+	{"close", (PyCFunction)LDAPValueIter_close, METH_NOARGS,
+	 "Stop the iteration and abandon the running request."
+	},
+	{NULL, NULL, 0, NULL}  /* Sentinel */
+};
+
+/*	Create a new LDAPValueIter for internal use, which gets the values of the `name`
+	attribute of the `dn` entry from the `first` index. The request of the first range
+	is sent immediately, so more iterators can wait for their responses concurrently.
+*/
+LDAPValueIter *
+LDAPValueIter_New(LDAPClient *client, const char *dn, PyObject *name, Py_ssize_t first) {
+	Py_ssize_t len;
+	const char *namestr;
+	LDAPValueIter *self;
+
+	namestr = PyUnicode_AsUTF8AndSize(name, &len);
+	if (namestr == NULL) return NULL;
+
+	self = (LDAPValueIter *)LDAPValueIterType.tp_alloc(&LDAPValueIterType, 0);
+	if (self == NULL) return (LDAPValueIter *)PyErr_NoMemory();
+	Py_INCREF(client);
+	self->client = client;
+	Py_INCREF(name);
+	self->name = name;
+	self->policy = LDAPClient_DecodePolicy(client, namestr, len);
+	self->msgid = -1;
+	self->next = first;
+	self->values = NULL;
+	self->pos = 0;
+	self->dn = strdup(dn);
+	if (self->dn == NULL) {
+		Py_DECREF(self);
+		return (LDAPValueIter *)PyErr_NoMemory();
+	}
+
+	if (send_range_request(self) != 0) {
+		Py_DECREF(self);
+		return NULL;
+	}
+	return self;
+}
+
+PyTypeObject LDAPValueIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "pyLDAP.LDAPValueIter",    /* tp_name */
+    sizeof(LDAPValueIter),     /* tp_basicsize */
+    0,                         /* tp_itemsize */
+    (destructor)LDAPValueIter_dealloc, /* tp_dealloc */
+    0,                         /* tp_print */
+    0,                         /* tp_getattr */
+    0,                         /* tp_setattr */
+    0,                         /* tp_reserved */
+    0,                         /* tp_repr */
+    0,                         /* tp_as_number */
+    0,                         /* tp_as_sequence */
+    0,                         /* tp_as_mapping */
+    0,                         /* tp_hash  */
+    0,                         /* tp_call */
+    0,                         /* tp_str */
+    0,                         /* tp_getattro */
+    0,                         /* tp_setattro */
+    0,                         /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,        /* tp_flags */
+    "LDAPValueIter object",    /* tp_doc */
+    0,                         /* tp_traverse */
+    0,                         /* tp_clear */
+    0,                         /* tp_richcompare */
+    0,                         /* tp_weaklistoffset */
+    PyObject_SelfIter,         /* tp_iter */
+    (iternextfunc)LDAPValueIter_iternext, /* tp_iternext */
+    LDAPValueIter_methods,     /* tp_methods */
+    0,                         /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
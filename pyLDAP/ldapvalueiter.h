@@ -0,0 +1,41 @@
+#ifndef LDAPVALUEITER_H_
+#define LDAPVALUEITER_H_
+
+#include <Python.h>
+#include "structmember.h"
+
+//MS Windows
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+#include <windows.h>
+#include <winldap.h>
+
+//Unix
+#else
+#include <ldap.h>
+
+#endif
+
+#include "ldapclient.h"
+
+/*	Iterates over the values of an attribute, which are retrieved range by range
+	(e.g. "member;range=0-1499", "member;range=1500-2999", ...). Only the values
+	of the current range are kept, the request of the next one is already sent. */
+typedef struct {
+	PyObject_HEAD
+	LDAPClient *client;
+	char *dn;
+	PyObject *name;
+	int policy;
+	int msgid;
+	Py_ssize_t next;
+	PyObject *values;
+	Py_ssize_t pos;
+} LDAPValueIter;
+
+extern PyTypeObject LDAPValueIterType;
+
+LDAPValueIter *LDAPValueIter_New(LDAPClient *client, const char *dn, PyObject *name, Py_ssize_t first);
+PyObject *LDAPValueIter_NextRange(LDAPValueIter *self);
+
+#endif /* LDAPVALUEITER_H_ */
@@ -13,7 +13,7 @@ LDAPValueList_clear(LDAPValueList *self) {
     self->deleted = NULL;
     Py_XDECREF(tmp);
 
-    Py_TYPE(self)->tp_base->tp_clear((PyObject *)self);
+    UniqueListType.tp_clear((PyObject *)self);
 
     return 0;
 }
@@ -21,15 +21,36 @@ LDAPValueList_clear(LDAPValueList *self) {
 /*	Deallocate the LDAPValueList. */
 static void
 LDAPValueList_dealloc(LDAPValueList *self) {
-	LDAPValueList_clear(self);
-	Py_TYPE(self)->tp_free((PyObject*)self);
+	PyObject_GC_UnTrack(self);
+	Py_CLEAR(self->added);
+	Py_CLEAR(self->deleted);
+	UniqueListType.tp_dealloc((PyObject *)self);
 }
 
 static int
 LDAPValueList_traverse(LDAPValueList *self, visitproc visit, void *arg) {
     Py_VISIT(self->deleted);
 	Py_VISIT(self->added);
-    return 0;
+    return UniqueListType.tp_traverse((PyObject *)self, visit, arg);
+}
+
+/* The recycled memory of the deallocated LDAPValueLists. */
+static LDAPFreeList freelist;
+
+static PyObject *
+LDAPValueList_alloc(PyTypeObject *type, Py_ssize_t nitems) {
+	return freelist_alloc(&freelist, type, nitems);
+}
+
+static void
+LDAPValueList_free(void *self) {
+	freelist_free(&freelist, self);
+}
+
+/*	Releases the recycled memory of the LDAPValueLists. */
+void
+LDAPValueList_ClearFreeList(void) {
+	freelist_clear(&freelist);
 }
 
 /*	Create a new LDAPValueList object. For tracking changes uses two other Python list,
@@ -68,25 +89,43 @@ LDAPValueList_New(void) {
 	return self;
 }
 
+/*	Untracks the LDAPValueList and its change lists by the garbage collector.
+	It is used only for received values (strings and bytes), which cannot be a part
+	of a cycle. A list is tracked again, when a trackable object is added to it. */
+void
+LDAPValueList_UnTrack(LDAPValueList *self) {
+	PyObject_GC_UnTrack(self->added);
+	PyObject_GC_UnTrack(self->deleted);
+	PyObject_GC_UnTrack(self);
+}
+
+/*	Registers the `item` as a new value: removes it from the deleted list,
+	or appends it to the added list, if it is not a previously deleted value.
+*/
+static int
+track_added(LDAPValueList *self, PyObject *item) {
+	int rc = UniqueList_Remove_wFlg(self->deleted, item);
+	if (rc == 0) rc = UniqueList_Append(self->added, item);
+	return rc == -1 ? -1 : 0;
+}
+
+/*	Registers the `item` as a removed value: removes it from the added list,
+	or appends it to the deleted list, if it is not a newly added value.
+*/
+static int
+track_deleted(LDAPValueList *self, PyObject *item) {
+	int rc = UniqueList_Remove_wFlg(self->added, item);
+	if (rc == 0) rc = UniqueList_Append(self->deleted, item);
+	return rc == -1 ? -1 : 0;
+}
+
 /*	Append new unique item to the LDAPValueList. Case-insensitive,
   	the `newitem` is also appended to the added list, or remove from the deleted list.
 */
 int
 LDAPValueList_Append(LDAPValueList *self, PyObject *newitem) {
-	int rc = -1;
-
-	rc = UniqueList_Append((UniqueList *)self, newitem);
-	if (rc == -1) return -1;
-
-	rc = UniqueList_Remove_wFlg(self->deleted, newitem);
-	if (rc == -1) return -1;
-	if (rc == 0) {
-		if (UniqueList_Append(self->added, newitem) == -1) {
-			PyErr_BadInternalCall();
-			return -1;
-		}
-	}
-	return 0;
+	if (UniqueList_Append((UniqueList *)self, newitem) != 0) return -1;
+	return track_added(self, newitem);
 }
 
 /*	Returns 1 if obj is an instance of LDAPEntry, or 0 if not.
@@ -98,26 +137,24 @@ LDAPValueList_Check(PyObject *obj) {
 	return PyObject_IsInstance(obj, (PyObject *)&LDAPValueListType);
 }
 
-/*	Removes the same items from both list. */
-static int
-balancing(PyObject *l1, UniqueList *l2) {
-	int rc;
+int
+LDAPValueList_Extend(LDAPValueList *self, PyObject *b) {
 	Py_ssize_t i;
+	PyObject *seq;
 
-	for (i = 0; i < Py_SIZE(l2); i++) {
-		rc = UniqueList_Remove_wFlg((UniqueList *)l1, l2->list.ob_item[i]);
-		if (rc == 1) {
-			UniqueList_SetSlice(l2, i, i+1, (PyObject *)NULL);
-		} else if (rc == -1) return -1;
+	seq = PySequence_Fast(b, "Argument is not iterable.");
+	if (seq == NULL) return -1;
+	if (UniqueList_Extend((UniqueList *)self, seq) != 0) {
+		Py_DECREF(seq);
+		return -1;
 	}
-	return 0;
-}
-
-int
-LDAPValueList_Extend(LDAPValueList *self, PyObject *b) {
-	if (balancing(b, self->deleted) != 0) return -1;
-	if (UniqueList_Extend(self->added, b) != 0) return -1;
-	if (UniqueList_Extend((UniqueList *)self, b) != 0) return -1;
+	for (i = 0; i < PySequence_Fast_GET_SIZE(seq); i++) {
+		if (track_added(self, PySequence_Fast_GET_ITEM(seq, i)) != 0) {
+			Py_DECREF(seq);
+			return -1;
+		}
+	}
+	Py_DECREF(seq);
 	return 0;
 }
 
@@ -126,33 +163,25 @@ LDAPValueList_Extend(LDAPValueList *self, PyObject *b) {
 */
 int
 LDAPValueList_Insert(LDAPValueList *self, Py_ssize_t where, PyObject *newitem) {
-	int rc = -1;
-
-	rc = UniqueList_Remove_wFlg(self->deleted, newitem);
-	if (rc == -1) return -1;
-	if (rc == 0) {
-		if (UniqueList_Append(self->added, newitem) == -1) {
-			PyErr_BadInternalCall();
-			return -1;
-		}
-	}
-    return UniqueList_Insert((UniqueList *)self, where, newitem);
+	if (UniqueList_Insert((UniqueList *)self, where, newitem) != 0) return -1;
+	return track_added(self, newitem);
 }
 
 int
 LDAPValueList_Remove(LDAPValueList *self, PyObject *value) {
-	int cmp;
 	Py_ssize_t i;
+	PyObject *match;
 
-	for (i = 0; i < Py_SIZE(self); i++) {
-		cmp = lowerCaseMatch(((PyListObject *)self)->ob_item[i], value);
-		if (cmp > 0) {
-			if (LDAPValueList_SetSlice(self, i, i+1, (PyObject *)NULL) == 0) return 0;
-			return -1;
-		} else if (cmp < 0) return -1;
+	match = UniqueList_Lookup((UniqueList *)self, value);
+	if (match == NULL) {
+		if (PyErr_Occurred()) return -1;
+		PyErr_SetString(PyExc_ValueError, "LDAPListValue.remove(x): x not in list");
+		return -1;
 	}
-	PyErr_SetString(PyExc_ValueError, "LDAPListValue.remove(x): x not in list");
-	return -1;
+	for (i = Py_SIZE(self) - 1; i >= 0; i--) {
+		if (((PyListObject *)self)->ob_item[i] == match) break;
+	}
+	return LDAPValueList_SetSlice(self, i, i+1, (PyObject *)NULL);
 }
 
 /*	Set new unique item at `i` index in LDAPValueList to `newitem`. Case-insensitive,
@@ -161,103 +190,291 @@ LDAPValueList_Remove(LDAPValueList *self, PyObject *value) {
 */
 int
 LDAPValueList_SetItem(LDAPValueList *self, Py_ssize_t i, PyObject *newitem) {
-	int rc = -1;
+	int rc;
 	PyObject *olditem;
 
-	if (UniqueList_SetItem((UniqueList *)self, i, newitem) != 0) return -1;
-
 	olditem = PyList_GetItem((PyObject *)self, i);
 	if (olditem == NULL) return -1;
-	rc = UniqueList_Remove_wFlg(self->added, olditem);
-	if (rc == -1) return -1;
-	if (rc == 0) {
-		if (UniqueList_Append(self->deleted, olditem) == -1) {
-			PyErr_BadInternalCall();
+	/* Hold the replaced item. */
+	Py_INCREF(olditem);
+	rc = UniqueList_SetItem((UniqueList *)self, i, newitem);
+	if (rc == 0) rc = track_deleted(self, olditem);
+	if (rc == 0) rc = track_added(self, newitem);
+	if (rc == 0) self->status = 1;
+	Py_DECREF(olditem);
+	return rc;
+}
+
+/*	Set the slice of LDAPValueList between `ilow` and `ihigh` to the contents of `itemlist`.
+	The `itemlist` must be containing unique elements. New items are append to the added list,
+	and removed items are append to the deleted list. The `itemlist` may be NULL, indicating
+	the assignment of an empty list (slice deletion).
+*/
+int
+LDAPValueList_SetSlice(LDAPValueList *self, Py_ssize_t ilow, Py_ssize_t ihigh, PyObject *itemlist) {
+	int rc = 0;
+	Py_ssize_t i;
+	PyObject *removed, *seq = NULL;
+
+	/* Copying the removable items, before they are released. */
+	removed = PyList_GetSlice((PyObject *)self, ilow, ihigh);
+	if (removed == NULL) return -1;
+	if (itemlist != NULL) {
+		seq = PySequence_Fast(itemlist, "can only assign an iterable");
+		if (seq == NULL) {
+			Py_DECREF(removed);
 			return -1;
 		}
 	}
+	rc = UniqueList_SetSlice((UniqueList *)self, ilow, ihigh, seq);
+	/* Removed items go to the deleted list, new items to the added list. */
+	for (i = 0; rc == 0 && i < PyList_GET_SIZE(removed); i++) {
+		rc = track_deleted(self, PyList_GET_ITEM(removed, i));
+	}
+	for (i = 0; rc == 0 && seq != NULL && i < PySequence_Fast_GET_SIZE(seq); i++) {
+		rc = track_added(self, PySequence_Fast_GET_ITEM(seq, i));
+	}
+	if (rc == 0) self->status = 1;
+	Py_DECREF(removed);
+	Py_XDECREF(seq);
+	return rc;
+}
 
-	rc = UniqueList_Remove_wFlg(self->deleted, newitem);
-	if (rc == -1) return -1;
-	if (rc == 0) {
-		if (UniqueList_Append(self->added, newitem) == -1) {
-			PyErr_BadInternalCall();
-			return -1;
+/*	Appends the values of the `values` sequence, which are not in the list yet, and merges
+	them into the change lists in linear time. The duplicates are ignored.
+	Returns 0 on success, -1 otherwise.
+*/
+int
+LDAPValueList_AddValues(LDAPValueList *self, PyObject *values) {
+	int rc = 0;
+	Py_ssize_t i;
+	PyObject *seq, *item, *readded;
+
+	seq = PySequence_Fast(values, "Argument is not iterable.");
+	if (seq == NULL) return -1;
+	/* The previously deleted values, which are added again. */
+	readded = PyList_New(0);
+	if (readded == NULL) rc = -1;
+	for (i = 0; rc == 0 && i < PySequence_Fast_GET_SIZE(seq); i++) {
+		item = PySequence_Fast_GET_ITEM(seq, i);
+		if (UniqueList_Lookup((UniqueList *)self, item) != NULL) continue;
+		if (PyErr_Occurred() || UniqueList_Append((UniqueList *)self, item) != 0) {
+			rc = -1;
+		} else if (UniqueList_Lookup(self->deleted, item) != NULL) {
+			rc = PyList_Append(readded, item);
+		} else {
+			rc = PyErr_Occurred() ? -1 : UniqueList_Append(self->added, item);
 		}
 	}
-	return 0;
+	if (rc == 0) rc = UniqueList_RemoveItems(self->deleted, readded, NULL);
+	if (rc == 0) self->status = 1;
+	Py_XDECREF(readded);
+	Py_DECREF(seq);
+	return rc;
 }
 
-/*	Set the slice of LDAPValueList between `ilow` and `ihigh` to the contents of `itemlist`.
-	The `itemlist` must be containing unique elements. New items are append to the added list,
-	and removed items are append to the deleted list. The `itemlist` may be NULL, indicating
-	the assignment of an empty list (slice deletion).
+/*	Removes the values of the `values` sequence from the list, and merges them into the
+	change lists in linear time. The missing values are ignored.
+	Returns 0 on success, -1 otherwise.
 */
 int
-LDAPValueList_SetSlice(LDAPValueList *self, Py_ssize_t ilow, Py_ssize_t ihigh, PyObject *itemlist) {
-	PyObject *remove;
+LDAPValueList_RemoveValues(LDAPValueList *self, PyObject *values) {
+	int rc = 0;
+	Py_ssize_t i;
+	PyObject *item, *removed, *unadded;
+
+	removed = PyList_New(0);
+	/* The newly added values, which are removed again. */
+	unadded = PyList_New(0);
+	if (removed == NULL || unadded == NULL) rc = -1;
+	if (rc == 0) rc = UniqueList_RemoveItems((UniqueList *)self, values, removed);
+	for (i = 0; rc == 0 && i < PyList_GET_SIZE(removed); i++) {
+		item = PyList_GET_ITEM(removed, i);
+		if (UniqueList_Lookup(self->added, item) != NULL) {
+			rc = PyList_Append(unadded, item);
+		} else if (UniqueList_Lookup(self->deleted, item) == NULL) {
+			rc = PyErr_Occurred() ? -1 : UniqueList_Append(self->deleted, item);
+		}
+	}
+	if (rc == 0) rc = UniqueList_RemoveItems(self->added, unadded, NULL);
+	if (rc == 0) self->status = 1;
+	Py_XDECREF(removed);
+	Py_XDECREF(unadded);
+	return rc;
+}
 
-	/* Copying the removable items from LDAPValueList to deleted list.*/
-	remove = PyList_GetSlice((PyObject *)self, ilow, ihigh);
-	if (remove == NULL) return -1;
-	if (balancing(remove, self->added) != 0) {
-		Py_DECREF(remove);
-		return -1;
+/*	Returns the value of the `old` list, which is stored on the server as the case-insensitive
+	match of the `item` (borrowed reference), or NULL if there is no such value. The `old`
+	list is either unchanged, or its changes are tracked in its added and deleted lists.
+	On error, returns NULL and sets an exception.
+*/
+static PyObject *
+lookup_stored(LDAPValueList *old, PyObject *item) {
+	PyObject *match;
+
+	match = UniqueList_Lookup((UniqueList *)old, item);
+	if (match == NULL && PyErr_Occurred()) return NULL;
+	if (old->status == -1) return match;
+	if (match != NULL) {
+		if (UniqueList_Lookup(old->added, item) == NULL) {
+			return PyErr_Occurred() ? NULL : match;
+		}
+		return NULL;
 	}
-	if (UniqueList_Extend(self->deleted, remove) != 0) {
-		Py_DECREF(remove);
-		return -1;
+	return UniqueList_Lookup(old->deleted, item);
+}
+
+/*	Checks the `item` of the stored values: if the `self` list does not contain it,
+	appends it to the `deleted` list. Returns 0 on success, -1 otherwise.
+*/
+static int
+diff_stored(LDAPValueList *self, UniqueList *deleted, PyObject *item) {
+	if (UniqueList_Lookup((UniqueList *)self, item) != NULL) return 0;
+	if (PyErr_Occurred()) return -1;
+	return UniqueList_Append(deleted, item);
+}
+
+/*	Sets the changes of the `self` list, which replaces the `old` values of an attribute,
+	to the value-level difference of the two lists: the values, which are not stored yet,
+	are added, the stored values, which are missing from the `self` list, are deleted.
+	The values are compared with the case-insensitive index of the lists.
+	Returns 1 if the difference is set, 0 if it is not smaller than the new values (or the
+	stored values are not known, or a value differs only in case), and -1 on error.
+*/
+int
+LDAPValueList_Diff(LDAPValueList *self, LDAPValueList *old) {
+	int rc = 0;
+	Py_ssize_t i;
+	PyObject *item, *match;
+	UniqueList *added = NULL;
+	UniqueList *deleted = NULL;
+
+	/* The values of a replaced attribute, which is not sent yet, are not known. */
+	if (old->status != -1 && old->status != 1) return 0;
+
+	added = UniqueList_New();
+	deleted = UniqueList_New();
+	if (added == NULL || deleted == NULL) goto Error;
+
+	for (i = 0; i < Py_SIZE(self); i++) {
+		item = PyList_GET_ITEM(self, i);
+		match = lookup_stored(old, item);
+		if (match == NULL) {
+			if (PyErr_Occurred() || UniqueList_Append(added, item) != 0) goto Error;
+		} else {
+			/* A change in case only has to be sent with a replace. */
+			rc = PyObject_RichCompareBool(match, item, Py_EQ);
+			if (rc == -1) goto Error;
+			if (rc == 0) goto Replace;
+		}
+		if (Py_SIZE(added) >= Py_SIZE(self)) goto Replace;
+	}
+	for (i = 0; i < Py_SIZE(old); i++) {
+		item = PyList_GET_ITEM(old, i);
+		if (old->status == 1) {
+			if (UniqueList_Lookup(old->added, item) != NULL) continue;
+			if (PyErr_Occurred()) goto Error;
+		}
+		if (diff_stored(self, deleted, item) != 0) goto Error;
+		if (Py_SIZE(added) + Py_SIZE(deleted) >= Py_SIZE(self)) goto Replace;
+	}
+	for (i = 0; old->status == 1 && i < Py_SIZE(old->deleted); i++) {
+		if (diff_stored(self, deleted, PyList_GET_ITEM(old->deleted, i)) != 0) goto Error;
+		if (Py_SIZE(added) + Py_SIZE(deleted) >= Py_SIZE(self)) goto Replace;
 	}
-	Py_DECREF(remove);
+	/* An empty list deletes the attribute with a replace. */
+	if (Py_SIZE(self) == 0) goto Replace;
+
+	Py_DECREF(self->added);
+	self->added = added;
+	Py_DECREF(self->deleted);
+	self->deleted = deleted;
+	return 1;
+Replace:
+	Py_DECREF(added);
+	Py_DECREF(deleted);
+	return 0;
+Error:
+	Py_XDECREF(added);
+	Py_XDECREF(deleted);
+	return -1;
+}
 
-	/* Copying new items to the added list.*/
-	if (itemlist != NULL) {
-		if (balancing(itemlist, self->deleted) != 0) return -1;
-		if (UniqueList_Extend(self->added, itemlist) != 0) return -1;
+static PyObject *
+LVL_add_values(LDAPValueList *self, PyObject *values) {
+	if (LDAPValueList_AddValues(self, values) == 0) {
+		Py_RETURN_NONE;
 	}
+	return NULL;
+}
 
-    return UniqueList_SetSlice((UniqueList *)self, ilow, ihigh, itemlist);
+static PyObject *
+LVL_remove_values(LDAPValueList *self, PyObject *values) {
+	if (LDAPValueList_RemoveValues(self, values) == 0) {
+		Py_RETURN_NONE;
+	}
+	return NULL;
 }
 
 static PyObject *
 LVL_append(LDAPValueList *self, PyObject *newitem) {
     if (LDAPValueList_Append(self, newitem) == 0) {
     	self->status = 1;
-    	return Py_None;
+    	Py_RETURN_NONE;
     }
     return NULL;
 }
 
+static PyObject *
+LVL_clear(LDAPValueList *self) {
+	if (LDAPValueList_SetSlice(self, 0, Py_SIZE(self), (PyObject *)NULL) == 0) {
+		self->status = 1;
+		Py_RETURN_NONE;
+	}
+	return NULL;
+}
+
 static PyObject *
 LVL_extend(LDAPValueList *self, PyObject *b) {
 	if (LDAPValueList_Extend(self, b) == 0) {
 		self->status = 1;
-		return Py_None;
+		Py_RETURN_NONE;
 	}
 	return NULL;
 }
 
 static PyObject *
-LVL_insert(LDAPValueList *self, PyObject *args) {
+LVL_insert(LDAPValueList *self, PyObject *const *args, Py_ssize_t nargs) {
     Py_ssize_t i;
     PyObject *v;
+    PyObject *values[2];
+    static char *kwlist[] = {"index", "object", NULL};
 
-    if (!PyArg_ParseTuple(args, "nO:insert", &i, &v)) return NULL;
+    if (unpack_args("insert", args, nargs, NULL, kwlist, 2, values) != 0) return NULL;
+    i = PyNumber_AsSsize_t(values[0], PyExc_OverflowError);
+    if (i == -1 && PyErr_Occurred()) return NULL;
+    v = values[1];
     if (LDAPValueList_Insert(self, i, v) == 0) {
     	self->status = 1;
-    	return Py_None;
+    	Py_RETURN_NONE;
     }
     return NULL;
 }
 
 static PyObject *
-LVL_pop(LDAPValueList *self, PyObject *args) {
+LVL_pop(LDAPValueList *self, PyObject *const *args, Py_ssize_t nargs) {
 	int status;
 	Py_ssize_t i = -1;
 	PyObject *value;
 
-	if (!PyArg_ParseTuple(args, "|n:pop", &i))
+	if (nargs > 1) {
+		PyErr_Format(PyExc_TypeError, "pop expected at most 1 argument, got %zd", nargs);
 		return NULL;
+	}
+	if (nargs == 1) {
+		i = PyNumber_AsSsize_t(args[0], PyExc_OverflowError);
+		if (i == -1 && PyErr_Occurred()) return NULL;
+	}
 
 	if (Py_SIZE(self) == 0) {
 		PyErr_SetString(PyExc_IndexError, "pop from empty list");
@@ -282,17 +499,22 @@ static PyObject *
 LVL_remove(LDAPValueList *self, PyObject *value) {
 	if (LDAPValueList_Remove(self, value) == 0) {
 		self->status = 1;
-		return Py_None;
+		Py_RETURN_NONE;
 	}
 	return NULL;
 }
 
 static PyMethodDef LDAPValueList_methods[] = {
+    {"add_values", (PyCFunction)LVL_add_values, METH_O,
+    		"Add the new items of an iterable to the LDAPValueList at once." },
     {"append", 	(PyCFunction)LVL_append, 	METH_O, "Append new item to the LDAPValueList." },
+    {"clear", 	(PyCFunction)LVL_clear, 	METH_NOARGS, "Remove every item from the LDAPValueList." },
     {"extend",  (PyCFunction)LVL_extend,  	METH_O, "Extend LDAPValueList."},
-    {"insert", 	(PyCFunction)LVL_insert,	METH_VARARGS, "Insert new item in the LDAPValueList."},
-    {"pop",		(PyCFunction)LVL_pop, 		METH_VARARGS, "Pop-pop."},
+    {"insert", 	(PyCFunction)LVL_insert,	METH_FASTCALL, "Insert new item in the LDAPValueList."},
+    {"pop",		(PyCFunction)LVL_pop, 		METH_FASTCALL, "Pop-pop."},
     {"remove", 	(PyCFunction)LVL_remove, 	METH_O, "Remove item from LDAPValueList."},
+    {"remove_values", (PyCFunction)LVL_remove_values, METH_O,
+    		"Remove the items of an iterable from the LDAPValueList at once, ignoring the missing ones."},
     {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
@@ -448,6 +670,7 @@ PyTypeObject LDAPValueListType = {
     0,                       /* tp_descr_set */
     0,                       /* tp_dictoffset */
     (initproc)LDAPValueList_init,/* tp_init */
-    0,                       /* tp_alloc */
+    LDAPValueList_alloc,     /* tp_alloc */
     LDAPValueList_new,      /* tp_new */
+    LDAPValueList_free,      /* tp_free */
 };
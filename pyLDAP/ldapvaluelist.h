@@ -16,6 +16,8 @@ typedef struct {
 extern PyTypeObject LDAPValueListType;
 
 LDAPValueList *LDAPValueList_New(void);
+void LDAPValueList_ClearFreeList(void);
+void LDAPValueList_UnTrack(LDAPValueList *self);
 int LDAPValueList_Append(LDAPValueList *self, PyObject *newitem);
 int LDAPValueList_Check(PyObject *obj);
 int LDAPValueList_Extend(LDAPValueList *self, PyObject *b);
@@ -23,5 +25,8 @@ int LDAPValueList_Insert(LDAPValueList *self, Py_ssize_t where, PyObject *newite
 int LDAPValueList_Remove(LDAPValueList *self, PyObject *value);
 int LDAPValueList_SetItem(LDAPValueList *self, Py_ssize_t i, PyObject *newitem);
 int LDAPValueList_SetSlice(LDAPValueList *self, Py_ssize_t ilow, Py_ssize_t ihigh, PyObject *itemlist);
+int LDAPValueList_AddValues(LDAPValueList *self, PyObject *values);
+int LDAPValueList_RemoveValues(LDAPValueList *self, PyObject *values);
+int LDAPValueList_Diff(LDAPValueList *self, LDAPValueList *old);
 
 #endif /* LDAPVALUELIST_H_ */
@@ -2,16 +2,52 @@
 
 #include "ldapclient.h"
 #include "ldapentry.h"
+#include "ldapfrozenentry.h"
+#include "ldapresultset.h"
+#include "ldapsearchiter.h"
+#include "ldapvalueiter.h"
 #include "ldapvaluelist.h"
+#include "utils.h"
+
+static int
+pyldap_traverse(PyObject *m, visitproc visit, void *arg) {
+    return traverse_module_state((pyLDAPState *)PyModule_GetState(m), visit, arg);
+}
+
+static int
+pyldap_clear(PyObject *m) {
+    clear_module_state((pyLDAPState *)PyModule_GetState(m));
+    return 0;
+}
+
+static void
+pyldap_free(void *m) {
+    pyldap_clear((PyObject *)m);
+    LDAPEntry_ClearFreeList();
+    LDAPValueList_ClearFreeList();
+    UniqueList_ClearFreeList();
+}
 
 static PyModuleDef pyldap2module = {
     PyModuleDef_HEAD_INIT,
     "_cpyLDAP",
     "Module to access directory servers using LDAP.",
-    -1,
-    NULL, NULL, NULL, NULL, NULL
+    sizeof(pyLDAPState),
+    NULL, NULL,
+    pyldap_traverse,
+    pyldap_clear,
+    pyldap_free
 };
 
+/*	Returns the state of the module with the cached Python objects,
+	or NULL if the module is not available (yet or anymore). */
+pyLDAPState *
+get_module_state(void) {
+    PyObject *m = PyState_FindModule(&pyldap2module);
+    if (m == NULL) return NULL;
+    return (pyLDAPState *)PyModule_GetState(m);
+}
+
 PyMODINIT_FUNC
 PyInit__cpyLDAP(void) {
     PyObject* m;
@@ -19,10 +55,18 @@ PyInit__cpyLDAP(void) {
     UniqueListType.tp_base = &PyList_Type;
     LDAPValueListType.tp_base = &UniqueListType;
     LDAPEntryType.tp_base = &PyDict_Type;
+    LDAPFrozenEntryType.tp_base = &PyDict_Type;
 
     if (PyType_Ready(&LDAPClientType) < 0) return NULL;
     if (PyType_Ready(&LDAPEntryType) < 0) return NULL;
+    if (PyType_Ready(&LDAPFrozenEntryType) < 0) return NULL;
     if (PyType_Ready(&LDAPValueListType) < 0) return NULL;
+    if (PyType_Ready(&LDAPSearchIterType) < 0) return NULL;
+    if (PyType_Ready(&LDAPValueIterType) < 0) return NULL;
+    if (PyType_Ready(&AttrLayoutType) < 0) return NULL;
+    if (PyType_Ready(&LDAPResultSetType) < 0) return NULL;
+    if (PyType_Ready(&LDAPResultRowType) < 0) return NULL;
+    if (PyType_Ready(&LDAPResultBufferType) < 0) return NULL;
 
     m = PyModule_Create(&pyldap2module);
     if (m == NULL) return NULL;
@@ -30,6 +74,12 @@ PyInit__cpyLDAP(void) {
     Py_INCREF(&LDAPEntryType);
     PyModule_AddObject(m, "LDAPEntry", (PyObject *)&LDAPEntryType);
 
+    Py_INCREF(&LDAPFrozenEntryType);
+    PyModule_AddObject(m, "LDAPFrozenEntry", (PyObject *)&LDAPFrozenEntryType);
+
+    Py_INCREF(&LDAPResultSetType);
+    PyModule_AddObject(m, "LDAPResultSet", (PyObject *)&LDAPResultSetType);
+
     Py_INCREF(&LDAPClientType);
     PyModule_AddObject(m, "LDAPClient", (PyObject *)&LDAPClientType);
 
@@ -1,9 +1,52 @@
 #include "uniquelist.h"
 #include "utils.h"
 
+static int
+UniqueList_clear(UniqueList *self) {
+	CaseIndex_Clear(&self->index);
+	return PyList_Type.tp_clear((PyObject *)self);
+}
+
 static void
 UniqueList_dealloc(UniqueList *self) {
-	Py_TYPE(self)->tp_free((PyObject*)self);
+	PyObject_GC_UnTrack(self);
+	CaseIndex_Clear(&self->index);
+	PyList_Type.tp_dealloc((PyObject *)self);
+}
+
+static int
+UniqueList_traverse(UniqueList *self, visitproc visit, void *arg) {
+	int rc = CaseIndex_Traverse(&self->index, visit, arg);
+	if (rc != 0) return rc;
+	return PyList_Type.tp_traverse((PyObject *)self, visit, arg);
+}
+
+/*	Tracks the list by the garbage collector again, if it has been untracked
+	(see LDAPValueList_UnTrack) and the new `item` could be a part of a cycle. */
+static void
+maintain_tracking(UniqueList *self, PyObject *item) {
+	if (!PyObject_GC_IsTracked((PyObject *)self) && PyObject_IS_GC(item)) {
+		PyObject_GC_Track(self);
+	}
+}
+
+/* The recycled memory of the deallocated UniqueLists. */
+static LDAPFreeList freelist;
+
+static PyObject *
+UniqueList_alloc(PyTypeObject *type, Py_ssize_t nitems) {
+	return freelist_alloc(&freelist, type, nitems);
+}
+
+static void
+UniqueList_free(void *self) {
+	freelist_free(&freelist, self);
+}
+
+/*	Releases the recycled memory of the UniqueLists. */
+void
+UniqueList_ClearFreeList(void) {
+	freelist_clear(&freelist);
 }
 
 /*	Create a new UniqueList object. */
@@ -17,61 +60,96 @@ UniqueList_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
 	return (PyObject *)self;
 }
 
-/*	Convert `list` object to a tuple, which contains only lowercase Python string elements. */
-static PyObject *
-get_lowercase_tuple(PyObject *list) {
-	char *str;
-	Py_ssize_t i, n;
-	PyObject *tup = NULL;
-	PyObject *seq, *item;
-
-	if (list == NULL) return NULL;
+/*	Restores the index after a failed replace_items() call. The first `n`
+	new `items` are removed, and the replaced items are inserted back.
+*/
+static void
+undo_index(UniqueList *self, Py_ssize_t ilow, Py_ssize_t ihigh, PyObject **items, Py_ssize_t n) {
+	Py_ssize_t i;
+	PyObject *type, *value, *tb;
 
-	seq = PySequence_Fast(list, "Argument is not iterable.");
-	n = PySequence_Fast_GET_SIZE(seq);
-	tup = PyTuple_New(n);
-	if (tup == NULL) return PyErr_NoMemory();
+	PyErr_Fetch(&type, &value, &tb);
+	for (i = 0; i < n; i++) {
+		CaseIndex_Remove(&self->index, items[i]);
+	}
+	for (i = ilow; i < ihigh; i++) {
+		CaseIndex_Insert(&self->index, self->list.ob_item[i]);
+	}
+	PyErr_Clear();
+	PyErr_Restore(type, value, tb);
+}
 
+/*	Replaces the items between `ilow` and `ihigh` with the items of the `seq` fast
+	sequence (which may be NULL), and keeps the case-insensitive index in sync.
+	Returns 0 on success, -1 on error. If the result would not be unique, nothing
+	is changed, the `dup` is set to the offending item, and 1 is returned.
+*/
+static int
+replace_items(UniqueList *self, Py_ssize_t ilow, Py_ssize_t ihigh, PyObject *seq, PyObject **dup) {
+	Py_ssize_t i, n = 0;
+	PyObject **items = NULL;
+	PyObject *match;
+
+	if (ilow < 0) ilow = 0;
+	else if (ilow > Py_SIZE(self)) ilow = Py_SIZE(self);
+	if (ihigh < ilow) ihigh = ilow;
+	else if (ihigh > Py_SIZE(self)) ihigh = Py_SIZE(self);
+
+	if (seq != NULL) {
+		n = PySequence_Fast_GET_SIZE(seq);
+		items = PySequence_Fast_ITEMS(seq);
+	}
+	/* Unindex the replaced items. */
+	for (i = ilow; i < ihigh; i++) {
+		if (CaseIndex_Remove(&self->index, self->list.ob_item[i]) == -1) {
+			undo_index(self, ilow, ihigh, items, 0);
+			return -1;
+		}
+	}
+	/* Index the new items, every one of them has to be unique. */
 	for (i = 0; i < n; i++) {
-		item = PySequence_Fast_GET_ITEM(seq, i);
-		str = lowercase(PyObject2char(item));
-		if (PyTuple_SetItem(tup, i, PyUnicode_FromString(str)) != 0) {
-			PyErr_BadInternalCall();
-			return NULL;
+		match = CaseIndex_Lookup(&self->index, items[i]);
+		if (match != NULL || PyErr_Occurred()) {
+			undo_index(self, ilow, ihigh, items, i);
+			if (match == NULL) return -1;
+			*dup = items[i];
+			return 1;
+		}
+		if (CaseIndex_Insert(&self->index, items[i]) != 0) {
+			undo_index(self, ilow, ihigh, items, i);
+			return -1;
 		}
-		free(str);
+		maintain_tracking(self, items[i]);
 	}
-
-	Py_XDECREF(seq);
-	return tup;
+	if (PyList_SetSlice((PyObject *)self, ilow, ihigh, seq) != 0) {
+		undo_index(self, ilow, ihigh, items, n);
+		return -1;
+	}
+	return 0;
 }
 
 /*	Initializing UniqueList. */
 static int
 UniqueList_init(UniqueList *self, PyObject *args, PyObject *kwds) {
-	Py_ssize_t i;
-	PyObject *tmp;
-	PyObject *item, *obj = NULL;
+	int rc;
+	PyObject *seq, *dup, *obj = NULL;
 
 	if (!PyArg_ParseTuple(args, "|O", &obj))
 	        return -1;
 
+	if (replace_items(self, 0, Py_SIZE(self), NULL, &dup) != 0) return -1;
+	if (obj == NULL) return 0;
+
+	seq = PySequence_Fast(obj, "Argument is not iterable.");
+	if (seq == NULL) return -1;
 	/* Checking, that the argument is containing unique values. */
-	if (obj != NULL) {
-	    tmp = get_lowercase_tuple(obj);
-		for (i = 0; i < Py_SIZE(tmp); i++) {
-			item = PyTuple_GetItem(tmp, i);
-			if (PySequence_Count(tmp, item) > 1) {
-				Py_DECREF(tmp);
-				PyErr_SetString(PyExc_AttributeError, "LDAPListValue's argument is containing non-unique values. (Bool types converted to number)");
-				return -1;
-			}
-		}
-		Py_DECREF(tmp);
-	}
-	if (PyList_Type.tp_init((PyObject *)self, args, kwds) < 0)
+	rc = replace_items(self, 0, 0, seq, &dup);
+	Py_DECREF(seq);
+	if (rc == 1) {
+		PyErr_SetString(PyExc_AttributeError, "LDAPListValue's argument is containing non-unique values. (Bool types converted to number)");
 		return -1;
-	return 0;
+	}
+	return rc;
 }
 
 /*	Create a new UniqueList object for internal use. */
@@ -81,31 +159,52 @@ UniqueList_New(void) {
 	return self;
 }
 
-/*	Returns 1 if the `newitem` is not in the list, 0 otherwise.
-	The function uses the lowerCaseMatch() to compare the list's items and the `newitem`
-	to lower-case C string.
+/*	Returns the stored item (borrowed reference), which is a case-insensitive
+	match of the `item`, or NULL if there is no match. On error, returns NULL
+	and sets an exception.
 */
-static int
-isLowerCaseUnique(UniqueList *list, PyObject *newitem) {
+PyObject *
+UniqueList_Lookup(UniqueList *self, PyObject *item) {
+	return CaseIndex_Lookup(&self->index, item);
+}
+
+/*	Returns the position of the `item` in the list. The `item` must be in the list. */
+static Py_ssize_t
+position(UniqueList *self, PyObject *item) {
 	Py_ssize_t i;
 
-	for (i = 0; i < Py_SIZE(list); i++) {
-		if (lowerCaseMatch(list->list.ob_item[i], newitem) == 1) {
-			return 0;
-		}
+	/* Searching backwards, because the recently added items are removed more often. */
+	for (i = Py_SIZE(self) - 1; i >= 0; i--) {
+		if (self->list.ob_item[i] == item) return i;
 	}
-	return 1;
+	return -1;
 }
 
-/*	Append new - case-insensitive - unique item to the UniqueList. */
-int
-UniqueList_Append(UniqueList *self, PyObject *newitem) {
-	if (isLowerCaseUnique(self, newitem) == 0) {
+/*	Inserts the unique `newitem` to the `where` position with the `insert` function. */
+static int
+add_item(UniqueList *self, Py_ssize_t where, PyObject *newitem) {
+	int rc;
+
+	if (UniqueList_Lookup(self, newitem) != NULL) {
 		PyErr_Format(PyExc_ValueError, "%R is already in the list.", newitem);
 		return -1;
 	}
+	if (PyErr_Occurred()) return -1;
+	if (CaseIndex_Insert(&self->index, newitem) != 0) return -1;
+	maintain_tracking(self, newitem);
+	if (where < 0) {
+		rc = PyList_Append((PyObject *)self, newitem);
+	} else {
+		rc = PyList_Insert((PyObject *)self, where, newitem);
+	}
+	if (rc != 0) CaseIndex_Remove(&self->index, newitem);
+	return rc;
+}
 
-	return PyList_Append((PyObject *)self, newitem);
+/*	Append new - case-insensitive - unique item to the UniqueList. */
+int
+UniqueList_Append(UniqueList *self, PyObject *newitem) {
+	return add_item(self, -1, newitem);
 }
 
 /*	Returns 1 if obj is an instance of UniqueList, or 0 if not.
@@ -119,52 +218,44 @@ UniqueList_Check(PyObject *obj) {
 
 int
 UniqueList_Extend(UniqueList *self, PyObject *b) {
-	PyObject *iter = NULL, *newitem, *ret;
-
-	if (b != NULL) iter = PyObject_GetIter(b);
-
-	if (iter != NULL) {
-		for (newitem = PyIter_Next(iter); newitem != NULL; newitem = PyIter_Next(iter)) {
-			if (isLowerCaseUnique(self, newitem) == 0){
-				PyErr_SetString(PyExc_TypeError, "List is containing non-unique values.");
-				return -1;
-			}
-			Py_DECREF(newitem);
-		}
-		Py_DECREF(iter);
+	int rc;
+	PyObject *seq, *dup;
+
+	seq = PySequence_Fast(b, "Argument is not iterable.");
+	if (seq == NULL) return -1;
+	rc = replace_items(self, Py_SIZE(self), Py_SIZE(self), seq, &dup);
+	Py_DECREF(seq);
+	if (rc == 1) {
+		PyErr_SetString(PyExc_TypeError, "List is containing non-unique values.");
+		return -1;
 	}
-
-	ret = _PyList_Extend((PyListObject *)self, b);
-	if (ret != Py_None) return -1;
-	return 0;
+	return rc;
 }
 
 /*	Insert new unique item to the `where` position in UniqueList. */
 int
 UniqueList_Insert(UniqueList *self, Py_ssize_t where, PyObject *newitem) {
-	if (isLowerCaseUnique(self, newitem) == 0) {
-		PyErr_Format(PyExc_ValueError, "%R is already in the list.", newitem);
-		return -1;
+	if (where < 0) {
+		where += Py_SIZE(self);
+		if (where < 0) where = 0;
 	}
-
-    return PyList_Insert((PyObject *)self, where, newitem);
+	return add_item(self, where, newitem);
 }
 
+/*	Removes the case-insensitive match of the `value` from the list.
+	Returns 1 if it is removed, 0 if it is not found, and -1 on error.
+*/
 int
 UniqueList_Remove_wFlg(UniqueList *self, PyObject *value) {
-	int cmp;
 	Py_ssize_t i;
+	PyObject *match;
 
-	for (i = 0; i < Py_SIZE(self); i++) {
-		cmp = lowerCaseMatch(self->list.ob_item[i], value);
-		if (cmp > 0) {
-			if (UniqueList_SetSlice(self, i, i+1, (PyObject *)NULL) == 0) {
-				return 1;
-			}
-			return -1;
-		} else if (cmp < 0) return -1;
-	}
-	return 0;
+	match = UniqueList_Lookup(self, value);
+	if (match == NULL) return PyErr_Occurred() ? -1 : 0;
+	i = position(self, match);
+	if (i == -1) return 0;
+	if (UniqueList_SetSlice(self, i, i+1, (PyObject *)NULL) == 0) return 1;
+	return -1;
 }
 
 int
@@ -181,13 +272,78 @@ UniqueList_Remove(UniqueList *self, PyObject *value) {
 	return -1;
 }
 
+/*	Removes the case-insensitive matches of the `values` sequence from the list in one pass,
+	the missing values are ignored. The removed items are appended to the `removed` list,
+	if it's not NULL. Returns 0 on success, -1 otherwise.
+*/
+int
+UniqueList_RemoveItems(UniqueList *self, PyObject *values, PyObject *removed) {
+	int rc = 0;
+	Py_ssize_t i;
+	PyObject *seq, *item, *match, *kept = NULL;
+	CaseIndex drop = {0};
+
+	seq = PySequence_Fast(values, "Argument is not iterable.");
+	if (seq == NULL) return -1;
+	/* Move the stored matches from the list's index to the `drop` index. */
+	for (i = 0; rc == 0 && i < PySequence_Fast_GET_SIZE(seq); i++) {
+		match = UniqueList_Lookup(self, PySequence_Fast_GET_ITEM(seq, i));
+		if (match == NULL) {
+			if (PyErr_Occurred()) rc = -1;
+			continue;
+		}
+		rc = CaseIndex_Insert(&drop, match);
+		if (rc == 0) rc = CaseIndex_Remove(&self->index, match) == -1 ? -1 : 0;
+	}
+	Py_DECREF(seq);
+	if (rc == 0 && drop.used > 0) {
+		kept = PyList_New(0);
+		if (kept == NULL) rc = -1;
+		/* The not indexed items, which differ only in case, are kept. */
+		for (i = 0; rc == 0 && i < Py_SIZE(self); i++) {
+			item = self->list.ob_item[i];
+			if (CaseIndex_Lookup(&drop, item) != item) {
+				rc = PyErr_Occurred() ? -1 : PyList_Append(kept, item);
+			} else if (removed != NULL) {
+				rc = PyList_Append(removed, item);
+			}
+		}
+		if (rc == 0) rc = PyList_SetSlice((PyObject *)self, 0, Py_SIZE(self), kept);
+		Py_XDECREF(kept);
+	}
+	/* On error, the items are put back to the list's index. */
+	for (i = 0; rc != 0 && i < drop.size; i++) {
+		if (drop.table[i].key != NULL) CaseIndex_Insert(&self->index, drop.table[i].key);
+	}
+	CaseIndex_Clear(&drop);
+	return rc;
+}
+
 /*	Set new unique item at `i` index in UniqueList to `newitem`. Case-insensitive. */
 int
 UniqueList_SetItem(UniqueList *self, Py_ssize_t i, PyObject *newitem) {
-	if (isLowerCaseUnique(self, newitem) == 0) {
+	PyObject *match, *olditem;
+
+	if (i < 0 || i >= Py_SIZE(self)) {
+		PyErr_SetString(PyExc_IndexError, "list assignment index out of range");
+		return -1;
+	}
+	olditem = self->list.ob_item[i];
+	/* The replaced item may have the same lower-case form. */
+	match = UniqueList_Lookup(self, newitem);
+	if (match != NULL && match != olditem) {
 		PyErr_Format(PyExc_ValueError, "%R is already in the list.", newitem);
 		return -1;
 	}
+	if (PyErr_Occurred()) return -1;
+	if (CaseIndex_Remove(&self->index, olditem) == -1) return -1;
+	if (CaseIndex_Insert(&self->index, newitem) != 0) {
+		CaseIndex_Insert(&self->index, olditem);
+		return -1;
+	}
+	maintain_tracking(self, newitem);
+	/* PyList_SetItem steals the reference. */
+	Py_INCREF(newitem);
 	return PyList_SetItem((PyObject *)self, i, newitem);
 }
 
@@ -197,65 +353,110 @@ UniqueList_SetItem(UniqueList *self, Py_ssize_t i, PyObject *newitem) {
 */
 int
 UniqueList_SetSlice(UniqueList *self, Py_ssize_t ilow, Py_ssize_t ihigh, PyObject *itemlist) {
-	PyObject *iter = NULL;
-	PyObject *newitem;
-
-	if (itemlist != NULL) iter = PyObject_GetIter(itemlist);
+	int rc;
+	PyObject *seq = NULL;
+	PyObject *dup;
 
-	if (iter != NULL) {
-		for (newitem = PyIter_Next(iter); newitem != NULL; newitem = PyIter_Next(iter)) {
-			if (isLowerCaseUnique(self, newitem) == 0) {
-				PyErr_Format(PyExc_ValueError, "%R is already in the list.", newitem);
-				return -1;
-			}
-			Py_DECREF(newitem);
-		}
-		Py_DECREF(iter);
+	if (itemlist != NULL) {
+		seq = PySequence_Fast(itemlist, "can only assign an iterable");
+		if (seq == NULL) return -1;
 	}
-
-    return PyList_SetSlice((PyObject *)self, ilow, ihigh, itemlist);
+	rc = replace_items(self, ilow, ihigh, seq, &dup);
+	if (rc == 1) {
+		PyErr_Format(PyExc_ValueError, "%R is already in the list.", dup);
+		rc = -1;
+	}
+	Py_XDECREF(seq);
+	return rc;
 }
 
 static PyObject *
 UL_append(UniqueList *self, PyObject *newitem) {
     if (UniqueList_Append(self, newitem) == 0) {
-    	return Py_None;
+    	Py_RETURN_NONE;
     }
     return NULL;
 }
 
+static PyObject *
+UL_clear(UniqueList *self) {
+	if (UniqueList_SetSlice(self, 0, Py_SIZE(self), (PyObject *)NULL) == 0) {
+		Py_RETURN_NONE;
+	}
+	return NULL;
+}
+
 static PyObject *
 UL_extend(UniqueList *self, PyObject *b) {
 	if (UniqueList_Extend(self, b) == 0) {
-		return Py_None;
+		Py_RETURN_NONE;
 	}
 	return NULL;
 }
 
 static PyObject *
-UL_insert(UniqueList *self, PyObject *args) {
+UL_insert(UniqueList *self, PyObject *const *args, Py_ssize_t nargs) {
     Py_ssize_t i;
     PyObject *v;
+    PyObject *values[2];
+    static char *kwlist[] = {"index", "object", NULL};
 
-    if (!PyArg_ParseTuple(args, "nO:insert", &i, &v)) return NULL;
+    if (unpack_args("insert", args, nargs, NULL, kwlist, 2, values) != 0) return NULL;
+    i = PyNumber_AsSsize_t(values[0], PyExc_OverflowError);
+    if (i == -1 && PyErr_Occurred()) return NULL;
+    v = values[1];
     if (UniqueList_Insert(self, i, v) == 0) {
-    	return Py_None;
+    	Py_RETURN_NONE;
     }
     return NULL;
 }
 
+static PyObject *
+UL_pop(UniqueList *self, PyObject *const *args, Py_ssize_t nargs) {
+	Py_ssize_t i = -1;
+	PyObject *value;
+
+	if (nargs > 1) {
+		PyErr_Format(PyExc_TypeError, "pop expected at most 1 argument, got %zd", nargs);
+		return NULL;
+	}
+	if (nargs == 1) {
+		i = PyNumber_AsSsize_t(args[0], PyExc_OverflowError);
+		if (i == -1 && PyErr_Occurred()) return NULL;
+	}
+
+	if (Py_SIZE(self) == 0) {
+		PyErr_SetString(PyExc_IndexError, "pop from empty list");
+		return NULL;
+	}
+	if (i < 0) i += Py_SIZE(self);
+	if (i < 0 || i >= Py_SIZE(self)) {
+		PyErr_SetString(PyExc_IndexError, "pop index out of range");
+		return NULL;
+	}
+	value = self->list.ob_item[i];
+	Py_INCREF(value);
+	if (UniqueList_SetSlice(self, i, i+1, (PyObject *)NULL) != 0) {
+		Py_DECREF(value);
+		return NULL;
+	}
+	return value;
+}
+
 static PyObject *
 UL_remove(UniqueList *self, PyObject *value) {
 	if (UniqueList_Remove(self, value) == 0) {
-		return Py_None;
+		Py_RETURN_NONE;
 	}
 	return NULL;
 }
 
 static PyMethodDef UniqueList_methods[] = {
     {"append", 	(PyCFunction)UL_append, 	METH_O, "Append new item to the UniqueList." },
+    {"clear", 	(PyCFunction)UL_clear, 	METH_NOARGS, "Remove every item from the UniqueList." },
     {"extend",  (PyCFunction)UL_extend,  	METH_O, "Extend UniqueList."},
-    {"insert", 	(PyCFunction)UL_insert,	METH_VARARGS, "Insert new item in the UniqueList."},
+    {"insert", 	(PyCFunction)UL_insert,	METH_FASTCALL, "Insert new item in the UniqueList."},
+    {"pop",		(PyCFunction)UL_pop, 	METH_FASTCALL, "Remove and return the item at index (default last)."},
     {"remove", 	(PyCFunction)UL_remove, 	METH_O, "Remove item from UniqueList."},
     {NULL, NULL, 0, NULL}  /* Sentinel */
 };
@@ -266,8 +467,10 @@ UL_concat(UniqueList *self, PyObject *bb) {
 
 	if (np == NULL) return PyErr_NoMemory();
 
-	if (UL_extend(np, (PyObject *)self) == NULL) return NULL;
-	if (UL_extend(np, bb) == NULL) return NULL;
+	if (UniqueList_Extend(np, (PyObject *)self) != 0 || UniqueList_Extend(np, bb) != 0) {
+		Py_DECREF(np);
+		return NULL;
+	}
 
 	return (PyObject *)np;
 }
@@ -285,17 +488,9 @@ UL_ass_item(UniqueList *self, Py_ssize_t i, PyObject *v) {
 
 static int
 UL_contains(UniqueList *self, PyObject *el) {
-    int cmp;
-	Py_ssize_t i;
-	PyObject *tup;
-
-	tup = get_lowercase_tuple((PyObject *)self);
-	if (tup == NULL) return -1;
-
-    for (i = 0, cmp = 0 ; cmp == 0 && i < Py_SIZE(tup); ++i) {
-    	cmp = lowerCaseMatch(PyTuple_GetItem(tup, i), el);
-    }
-    return cmp;
+	if (UniqueList_Lookup(self, el) != NULL) return 1;
+	if (PyErr_Occurred()) return -1;
+	return 0;
 }
 
 static PyObject *
@@ -439,10 +634,11 @@ PyTypeObject UniqueListType = {
     0,                       /* tp_setattro */
     0,                       /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT |
-        Py_TPFLAGS_BASETYPE, /* tp_flags */
+        Py_TPFLAGS_BASETYPE |
+        Py_TPFLAGS_HAVE_GC, /* tp_flags */
     0,                       /* tp_doc */
-    0,    					 /* tp_traverse */
-    0,                       /* tp_clear */
+    (traverseproc)UniqueList_traverse, /* tp_traverse */
+    (inquiry)UniqueList_clear, /* tp_clear */
     0,                       /* tp_richcompare */
     0,                       /* tp_weaklistoffset */
     0,                       /* tp_iter */
@@ -456,6 +652,7 @@ PyTypeObject UniqueListType = {
     0,                       /* tp_descr_set */
     0,                       /* tp_dictoffset */
     (initproc)UniqueList_init,/* tp_init */
-    0,                       /* tp_alloc */
+    UniqueList_alloc,        /* tp_alloc */
     UniqueList_new,      /* tp_new */
+    UniqueList_free,         /* tp_free */
 };
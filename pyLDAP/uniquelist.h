@@ -4,19 +4,25 @@
 #include <Python.h>
 #include "structmember.h"
 
+#include "caseindex.h"
+
 typedef struct {
 	PyListObject list;
+	CaseIndex index;
 } UniqueList;
 
 extern PyTypeObject UniqueListType;
 
 UniqueList *UniqueList_New(void);
+void UniqueList_ClearFreeList(void);
 int UniqueList_Append(UniqueList *self, PyObject *newitem);
 int UniqueList_Check(PyObject *obj);
 int UniqueList_Extend(UniqueList *self, PyObject *b);
+PyObject *UniqueList_Lookup(UniqueList *self, PyObject *item);
 int UniqueList_Insert(UniqueList *self, Py_ssize_t where, PyObject *newitem);
 int UniqueList_Remove_wFlg(UniqueList *self, PyObject *value);
 int UniqueList_Remove(UniqueList *self, PyObject *value);
+int UniqueList_RemoveItems(UniqueList *self, PyObject *values, PyObject *removed);
 int UniqueList_SetItem(UniqueList *self, Py_ssize_t i, PyObject *newitem);
 int UniqueList_SetSlice(UniqueList *self, Py_ssize_t ilow, Py_ssize_t ihigh, PyObject *itemlist);
 
@@ -13,74 +13,127 @@ lowercase(char *str) {
 	return str;
 }
 
-/* Create a berval structure from a char*. */
+/*	Creates a berval structure from the `obj` Python object. The value of strings and
+	bytes is borrowed from the object, other objects are converted into the `tofree`
+	buffer. The berval is valid while the `obj` is alive, the `tofree` has to be freed
+	with it. */
 struct berval *
-createBerval(char *value) {
+createBerval(PyObject *obj, char **tofree) {
+	Py_ssize_t len;
+	const char *value;
 	struct berval *bval = NULL;
+
+	value = PyObject2buffer(obj, &len, tofree);
+	if (value == NULL) return NULL;
 	bval = malloc(sizeof(struct berval));
-	if (bval == NULL) return NULL;
-	bval->bv_len = strlen(value);
-	bval->bv_val = value;
+	if (bval == NULL) {
+		free(*tofree);
+		*tofree = NULL;
+		return (struct berval *)PyErr_NoMemory();
+	}
+	bval->bv_len = len;
+	bval->bv_val = (char *)value;
 	return bval;
 }
 
-/*	Converts a berval structure to a Python bytearray or if it's possible to string. */
-PyObject *
-berval2PyObject(struct berval *bval) {
-	PyObject *bytes;
-	PyObject *obj;
+/*	Checks that the first `len` bytes of `str` are valid UTF-8 (the same as the strict
+	decoder of Python: no overlong forms, no surrogates, nothing above U+10FFFF).
+	Where SSE2 is available, the ASCII parts are skipped 16 bytes at once.
+	Returns 1 if it's valid, 0 otherwise. */
+int
+isValidUTF8(const char *str, Py_ssize_t len) {
+	Py_ssize_t i = 0;
+	const unsigned char *s = (const unsigned char *)str;
+	unsigned char c, lo, hi;
+	int n;
+
+	while (i < len) {
+#ifdef _LDAP_SSE2
+		while (i + 16 <= len && _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i))) == 0) {
+			i += 16;
+		}
+		if (i >= len) break;
+#endif
+		c = s[i];
+		if (c < 0x80) {
+			i++;
+			continue;
+		}
+		/* The number of the continuation bytes, and the range of the first one. */
+		lo = 0x80;
+		hi = 0xBF;
+		if (c >= 0xC2 && c <= 0xDF) {
+			n = 1;
+		} else if (c >= 0xE0 && c <= 0xEF) {
+			n = 2;
+			if (c == 0xE0) lo = 0xA0;
+			else if (c == 0xED) hi = 0x9F;
+		} else if (c >= 0xF0 && c <= 0xF4) {
+			n = 3;
+			if (c == 0xF0) lo = 0x90;
+			else if (c == 0xF4) hi = 0x8F;
+		} else {
+			return 0;
+		}
+		if (i + n >= len) return 0;
+		if (s[i + 1] < lo || s[i + 1] > hi) return 0;
+		if (n > 1 && (s[i + 2] & 0xC0) != 0x80) return 0;
+		if (n > 2 && (s[i + 3] & 0xC0) != 0x80) return 0;
+		i += n + 1;
+	}
+	return 1;
+}
 
-	bytes = PyBytes_FromStringAndSize(bval->bv_val, bval->bv_len);
-	if (bytes == NULL) {
-		PyErr_BadInternalCall();
-		return NULL;
+/*	Converts a berval structure to a Python object depending on the `policy`:
+	_LDAP_DECODE_BYTES returns bytes, _LDAP_DECODE_STR returns string (the invalid
+	bytes are replaced), _LDAP_DECODE_AUTO returns string if the value is valid UTF-8,
+	and bytes otherwise. The value is checked before creating any object. */
+PyObject *
+berval2PyObject(struct berval *bval, int policy) {
+	if (policy == _LDAP_DECODE_STR) {
+		return PyUnicode_DecodeUTF8(bval->bv_val, bval->bv_len, "replace");
 	}
-	obj = PyUnicode_FromEncodedObject(bytes, NULL, NULL);
-	/* Unicode converting is failed, set bytearray to return value. */
-	if (obj == NULL) {
-		obj = bytes;
-	} else {
-		Py_DECREF(bytes);
-	}
-	/* Check for errors. */
-	if (PyErr_Occurred()) {
-		/* Should be a reason why there is nothing about
-		   PyExc_UnicodeDecodeError in the official documentation. */
-		if (PyErr_ExceptionMatches(PyExc_UnicodeDecodeError) == 1) {
-			/* UnicodeDecode error is excepted and will be ignored.*/
-			PyErr_Clear();
-		}
+	if (policy == _LDAP_DECODE_AUTO && isValidUTF8(bval->bv_val, bval->bv_len)) {
+		return PyUnicode_DecodeUTF8(bval->bv_val, bval->bv_len, NULL);
 	}
-	return obj;
+	return PyBytes_FromStringAndSize(bval->bv_val, bval->bv_len);
 }
 
+/*	Creates an LDAPMod in the `arena` for the `key` attribute with the `value` list
+	(or without values, if it's NULL). Returns NULL if it's failed. */
 LDAPMod *
-createLDAPModFromItem(int mod_op, PyObject *key, PyObject *value) {
+createLDAPModFromItem(LDAPArena *arena, int mod_op, PyObject *key, PyObject *value) {
+	Py_ssize_t len;
 	LDAPMod *mod;
 
-	mod = (LDAPMod *)malloc(sizeof(LDAPMod));
+	mod = (LDAPMod *)arena_alloc(arena, sizeof(LDAPMod));
 	if (mod == NULL) return NULL;
 
 	mod->mod_op = mod_op;
-	mod->mod_type = PyObject2char(key);
-	mod->mod_vals.modv_bvals = PyList2BervalList(value);
+	if (arena_keep(arena, key) != 0) return NULL;
+	mod->mod_type = (char *)arena_buffer(arena, key, &len);
+	if (mod->mod_type == NULL) return NULL;
+	mod->mod_vals.modv_bvals = NULL;
+	if (value != NULL) {
+		mod->mod_vals.modv_bvals = arena_berval_list(arena, value);
+		if (mod->mod_vals.modv_bvals == NULL) return NULL;
+	}
 	return mod;
 }
 
-/*	Converts Python simple objects (String, Long, Float, Boolean, Bytes, and None) to C string.
+/*	Converts Python simple objects (String, Long, Float, Boolean, Bytes, bytes-like
+	objects, LDAPDN and None) to a newly allocated C string. Strings are encoded in UTF-8.
 	If the `obj` is none of these types raise BadInternalCall() error and return NULL.
 */
 char *
 PyObject2char(PyObject *obj) {
 	char *str = NULL;
 	char *tmp = NULL;
-	const wchar_t *wstr;
 	Py_ssize_t length = 0;
-	PyObject *ldapdn_type = load_python_object("pyLDAP.ldapdn", "LDAPDN");
+	PyObject *ldapdn_type;
 	const unsigned int len = 24; /* The max length that a number's char* representation can be. */
 
 	if (obj == NULL) return NULL;
-	if (ldapdn_type == NULL) return NULL;
 
 	/* If Python objects is a None return an empty("") char*. */
 	if (obj == Py_None) {
@@ -88,14 +141,16 @@ PyObject2char(PyObject *obj) {
 		str[0] = '\0';
 		return str;
 	}
-	if (PyUnicode_Check(obj)) {
-		/* Python string converting. From Python 3.3 could be use PyUnicode_AsUTF8AndSize(). */
-		wstr = PyUnicode_AsWideCharString(obj, &length);
+	if (PyUnicode_Check(obj) || PyBytes_Check(obj) || PyObject_CheckBuffer(obj)) {
+		/* Python string, bytes and bytes-like objects are copied in UTF-8. */
+		const char *buffer = PyObject2buffer(obj, &length, &tmp);
+		if (buffer == NULL) return NULL;
+		if (tmp != NULL) return tmp;
 		str = (char *)malloc(sizeof(char) * (length + 1));
 		if (str == NULL) return (char *)PyErr_NoMemory();
-		wcstombs(str, wstr, length);
-		/* Put the delimiter at the end. */
+		memcpy(str, buffer, length);
 		str[length] = '\0';
+		return str;
 	} else if (PyLong_Check(obj)) {
 		/* Python integer converting. Could be longer, literally. */
 		long int inum = PyLong_AsLong(obj);
@@ -115,14 +170,7 @@ PyObject2char(PyObject *obj) {
 		} else {
 			str = "0";
 		}
-	} else if (PyBytes_Check(obj)) {
-		/* Python bytes converting. */
-		tmp = PyBytes_AsString(obj);
-		if (tmp == NULL) return NULL;
-		str = (char *)malloc(sizeof(char) * (strlen(tmp) + 1));
-		strcpy(str, tmp);
-		return str;
-	} else if (PyObject_IsInstance(obj, ldapdn_type)) {
+	} else if ((ldapdn_type = get_ldapdn_type()) != NULL && PyObject_IsInstance(obj, ldapdn_type)) {
 		/* LDAPDN object converting. */
 		PyObject *tmpobj = PyObject_Str(obj);
 		str = PyObject2char(tmpobj);
@@ -139,71 +187,488 @@ PyObject2char(PyObject *obj) {
 	return str;
 }
 
-struct berval **
-PyList2BervalList(PyObject *list) {
-	int i = 0;
-	char *strvalue;
-	struct berval **berval_arr = NULL;
-	PyObject *iter;
-	PyObject *item;
+/*	Returns the byte string of the `obj` Python object with its length. Strings (in UTF-8)
+	and bytes are used without copying, the buffer belongs to the object and it is valid
+	while the object is alive. Other bytes-like objects are copied, and other values are
+	converted with PyObject2char() into the `tofree` buffer, which has to be freed.
+*/
+const char *
+PyObject2buffer(PyObject *obj, Py_ssize_t *len, char **tofree) {
+	Py_buffer view;
+
+	*tofree = NULL;
+	if (PyUnicode_Check(obj)) return PyUnicode_AsUTF8AndSize(obj, len);
+	if (PyBytes_Check(obj)) {
+		*len = PyBytes_GET_SIZE(obj);
+		return PyBytes_AS_STRING(obj);
+	}
+	if (PyObject_CheckBuffer(obj)) {
+		/* The content of a mutable buffer (e.g. bytearray) can change, copy it. */
+		if (PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) != 0) return NULL;
+		*tofree = (char *)malloc(view.len + 1);
+		if (*tofree == NULL) {
+			PyBuffer_Release(&view);
+			return (const char *)PyErr_NoMemory();
+		}
+		memcpy(*tofree, view.buf, view.len);
+		(*tofree)[view.len] = '\0';
+		*len = view.len;
+		PyBuffer_Release(&view);
+		return *tofree;
+	}
+	*tofree = PyObject2char(obj);
+	if (*tofree == NULL) return NULL;
+	*len = (Py_ssize_t)strlen(*tofree);
+	return *tofree;
+}
 
-	if (list == NULL || !PyList_Check(list)) return NULL;
+/* A value of a Python list converted by PyObject2buffer(). */
+typedef struct {
+	const char *value;
+	Py_ssize_t len;
+	char *tofree;
+} bufferItem;
+
+static void
+free_buffer_items(bufferItem *items, Py_ssize_t n) {
+	Py_ssize_t i;
 
-	berval_arr = (struct berval **)malloc(sizeof(struct berval *) * ((int)PyList_Size(list) + 1));
-	iter = PyObject_GetIter(list);
-	if (iter == NULL) return NULL;
+	for (i = 0; i < n; i++) {
+		free(items[i].tofree);
+	}
+	free(items);
+}
 
-	for (item = PyIter_Next(iter); item != NULL; item = PyIter_Next(iter)) {
-		strvalue = PyObject2char(item);
-		berval_arr[i++] = createBerval(strvalue);
-		Py_DECREF(item);
+/*	Converts the items of the `list` with PyObject2buffer() into the `bufitems` array,
+	and sums their lengths in `total`. Returns a tuple of the list's items, which keeps
+	the borrowed buffers alive, or NULL if it's failed.
+*/
+static PyObject *
+list2buffers(PyObject *list, bufferItem **bufitems, Py_ssize_t *total) {
+	Py_ssize_t i, n;
+	PyObject *items;
+
+	/* Snapshot of the items, the list could be changed by a conversion. */
+	items = PySequence_Tuple(list);
+	if (items == NULL) return NULL;
+	n = PyTuple_GET_SIZE(items);
+
+	*total = 0;
+	*bufitems = (bufferItem *)malloc(sizeof(bufferItem) * (n + 1));
+	if (*bufitems == NULL) {
+		Py_DECREF(items);
+		return PyErr_NoMemory();
+	}
+	for (i = 0; i < n; i++) {
+		(*bufitems)[i].value = PyObject2buffer(PyTuple_GET_ITEM(items, i),
+				&(*bufitems)[i].len, &(*bufitems)[i].tofree);
+		if ((*bufitems)[i].value == NULL) {
+			free_buffer_items(*bufitems, i);
+			Py_DECREF(items);
+			return NULL;
+		}
+		*total += (*bufitems)[i].len;
+	}
+	return items;
+}
+
+/* Initialises an empty arena. */
+void
+arena_init(LDAPArena *arena) {
+	arena->blocks = NULL;
+	arena->refs = NULL;
+}
+
+/*	Allocates `size` bytes, aligned for pointers, from the `arena`. The memory is valid
+	until arena_free(). Returns NULL and sets MemoryError if it's failed. */
+void *
+arena_alloc(LDAPArena *arena, size_t size) {
+	size_t blocksize;
+	char *ptr;
+	LDAPArenaBlock *block = arena->blocks;
+
+	size = (size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+	if (block == NULL || block->size - block->used < size) {
+		blocksize = size > _LDAP_ARENA_BLOCK_SIZE ? size : _LDAP_ARENA_BLOCK_SIZE;
+		block = (LDAPArenaBlock *)malloc(sizeof(LDAPArenaBlock) + blocksize);
+		if (block == NULL) return PyErr_NoMemory();
+		block->size = blocksize;
+		block->used = 0;
+		/* Keep filling the current block after an oversized allocation. */
+		if (size > _LDAP_ARENA_BLOCK_SIZE && arena->blocks != NULL) {
+			block->next = arena->blocks->next;
+			arena->blocks->next = block;
+		} else {
+			block->next = arena->blocks;
+			arena->blocks = block;
+		}
+	}
+	ptr = (char *)(block + 1) + block->used;
+	block->used += size;
+	return ptr;
+}
+
+/*	Keeps a reference to the `obj` until arena_free(), so its buffer can be borrowed.
+	Returns 0 on success, -1 otherwise. */
+int
+arena_keep(LDAPArena *arena, PyObject *obj) {
+	if (arena->refs == NULL) {
+		arena->refs = PyList_New(0);
+		if (arena->refs == NULL) return -1;
 	}
-	Py_DECREF(iter);
-	berval_arr[i] = NULL;
+	return PyList_Append(arena->refs, obj);
+}
+
+/*	Returns the NUL-terminated byte string of the `obj` with its length. Strings and bytes
+	are referenced without copying, so the `obj` has to be kept alive while the arena is
+	used. Other values are converted with PyObject2buffer() and copied into the arena. */
+const char *
+arena_buffer(LDAPArena *arena, PyObject *obj, Py_ssize_t *len) {
+	char *tofree = NULL;
+	char *copy;
+	const char *value;
+
+	value = PyObject2buffer(obj, len, &tofree);
+	if (value == NULL || tofree == NULL) return value;
+	copy = (char *)arena_alloc(arena, *len + 1);
+	if (copy != NULL) {
+		memcpy(copy, tofree, *len);
+		copy[*len] = '\0';
+	}
+	free(tofree);
+	return copy;
+}
+
+/*	Converts the Python `list` to a NULL-terminated berval list in the `arena`. The values
+	can contain any bytes. The strings and bytes are referenced without copying, the arena
+	keeps a snapshot of the list's items alive. Returns NULL if it's failed.
+*/
+struct berval **
+arena_berval_list(LDAPArena *arena, PyObject *list) {
+	int rc;
+	Py_ssize_t i, n, len;
+	const char *value;
+	struct berval *bvals;
+	struct berval **berval_arr;
+	PyObject *items;
+
+	/* Snapshot of the items, the list could be changed by a conversion. */
+	items = PySequence_Tuple(list);
+	if (items == NULL) return NULL;
+	rc = arena_keep(arena, items);
+	Py_DECREF(items);
+	if (rc != 0) return NULL;
+	n = PyTuple_GET_SIZE(items);
+
+	berval_arr = (struct berval **)arena_alloc(arena, sizeof(struct berval *) * (n + 1)
+			+ sizeof(struct berval) * n);
+	if (berval_arr == NULL) return NULL;
+	bvals = (struct berval *)(berval_arr + n + 1);
+	for (i = 0; i < n; i++) {
+		value = arena_buffer(arena, PyTuple_GET_ITEM(items, i), &len);
+		if (value == NULL) return NULL;
+		bvals[i].bv_val = (char *)value;
+		bvals[i].bv_len = len;
+		berval_arr[i] = &bvals[i];
+	}
+	berval_arr[n] = NULL;
 	return berval_arr;
 }
 
-/*	Converts Python list to a C string list. Retruns NULL if it's failed. */
+/* Releases the memory of the `arena` and the objects kept by it. */
+void
+arena_free(LDAPArena *arena) {
+	LDAPArenaBlock *block;
+
+	while (arena->blocks != NULL) {
+		block = arena->blocks;
+		arena->blocks = block->next;
+		free(block);
+	}
+	Py_CLEAR(arena->refs);
+}
+
+/*	Converts Python list to a NULL-terminated C string list. The list and the strings are
+	allocated in one memory block, that has to be freed with free_string_list().
+	Returns NULL if the `list` is not a list or the conversion is failed.
+*/
 char **
 PyList2StringList(PyObject *list) {
-	int i = 0;
+	Py_ssize_t i, n, total;
+	char *data;
 	char **strlist;
-	PyObject *iter;
-	PyObject *item;
+	bufferItem *bufitems;
+	PyObject *items;
 
 	if (list == NULL || !PyList_Check(list)) return NULL;
 
-	strlist = malloc(sizeof(char*) * ((int)PyList_Size(list) + 1));
-	iter = PyObject_GetIter(list);
-	if (iter == NULL) return NULL;
+	items = list2buffers(list, &bufitems, &total);
+	if (items == NULL) return NULL;
+	n = PyTuple_GET_SIZE(items);
 
-	for (item = PyIter_Next(iter); item != NULL; item = PyIter_Next(iter)) {
-		strlist[i++] = PyObject2char(item);
-		Py_DECREF(item);
+	strlist = (char **)malloc(sizeof(char *) * (n + 1) + total + n);
+	if (strlist == NULL) {
+		PyErr_NoMemory();
+	} else {
+		data = (char *)(strlist + n + 1);
+		for (i = 0; i < n; i++) {
+			memcpy(data, bufitems[i].value, bufitems[i].len);
+			data[bufitems[i].len] = '\0';
+			strlist[i] = data;
+			data += bufitems[i].len + 1;
+		}
+		strlist[n] = NULL;
 	}
-	Py_DECREF(iter);
-	strlist[i] = NULL;
+	free_buffer_items(bufitems, n);
+	Py_DECREF(items);
 	return strlist;
 }
 
-/*	Compare lower-case representations of two Python objects.
+/*	Frees a C string list created by PyList2StringList(). */
+void
+free_string_list(char **strlist) {
+	free(strlist);
+}
+
+#ifdef _LDAP_SSE2
+/*	Lower-cases the ASCII capital letters of 16 bytes. The signed comparison
+	leaves the non-ASCII bytes (>= 0x80) unchanged. */
+static inline __m128i
+fold16(__m128i x) {
+	__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)),
+			_mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1)));
+	return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+/*	Compares the first `len` bytes of two strings ASCII case-insensitively,
+	without allocating lower-cased copies. Compares 16 bytes at once where
+	SSE2 is available. Returns 1 if they are equal, 0 otherwise. */
+int
+asciiCaseEqual(const char *s1, const char *s2, Py_ssize_t len) {
+	Py_ssize_t i = 0;
+	unsigned char c1, c2;
+
+#ifdef _LDAP_SSE2
+	__m128i a, b;
+
+	for (; i + 16 <= len; i += 16) {
+		a = _mm_loadu_si128((const __m128i *)(s1 + i));
+		b = _mm_loadu_si128((const __m128i *)(s2 + i));
+		/* Skip folding, when the bytes are identical. */
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF) continue;
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(fold16(a), fold16(b))) != 0xFFFF) return 0;
+	}
+#endif
+	for (; i < len; i++) {
+		c1 = (unsigned char)s1[i];
+		c2 = (unsigned char)s2[i];
+		if (c1 == c2) continue;
+		if (c1 >= 'A' && c1 <= 'Z') c1 += 'a' - 'A';
+		if (c2 >= 'A' && c2 <= 'Z') c2 += 'a' - 'A';
+		if (c1 != c2) return 0;
+	}
+	return 1;
+}
+
+/*	Parses the range option of a `len` long attribute description, which is sent by the server
+	(e.g. Active Directory) instead of the plain name for an attribute with too many values:
+	"member;range=0-1499". Sets `next` to the first index of the following range, or to -1 if
+	the end of the range is "*" (the last one). Returns the length of the attribute's name
+	before the option, or -1 if there is no valid range option. */
+Py_ssize_t
+parse_attr_range(const char *attr, Py_ssize_t len, Py_ssize_t *next) {
+	Py_ssize_t i, j, high = 0;
+
+	for (i = 0; i + 7 < len; i++) {
+		if (attr[i] == ';' && asciiCaseEqual(attr + i + 1, "range=", 6)) break;
+	}
+	if (i + 7 >= len) return -1;
+	/* Skip the lower bound. */
+	for (j = i + 7; j < len && attr[j] >= '0' && attr[j] <= '9'; j++);
+	if (j == i + 7 || j + 1 >= len || attr[j++] != '-') return -1;
+	if (attr[j] == '*') {
+		*next = -1;
+		return i;
+	}
+	for (; j < len && attr[j] >= '0' && attr[j] <= '9'; j++) {
+		high = high * 10 + (attr[j] - '0');
+	}
+	if (j < len && attr[j] != ';') return -1;
+	*next = high + 1;
+	return i;
+}
+
+/*	Compare lower-case representations of two Python objects. Strings and bytes
+	are compared in their own buffer without any allocation, the ASCII letters
+	are case-insensitive, other characters have to be the same.
 	Returns 1 they are matched, -1 if it's failed, and 0 otherwise. */
 int
 lowerCaseMatch(PyObject *o1, PyObject *o2) {
 	int match = 0;
-	char *str1 = lowercase(PyObject2char(o1));
-	char *str2 = lowercase(PyObject2char(o2));
-
-	if (str1 == NULL || str2 == NULL) return -1;
+	Py_ssize_t len1, len2;
+	char *tofree1, *tofree2;
+	const char *str1, *str2;
+
+	if (o1 == o2) return 1;
+	str1 = PyObject2buffer(o1, &len1, &tofree1);
+	if (str1 == NULL) return -1;
+	str2 = PyObject2buffer(o2, &len2, &tofree2);
+	if (str2 == NULL) {
+		free(tofree1);
+		return -1;
+	}
 
-	if (strcmp(str1, str2) == 0) match = 1;
+	if (len1 == len2) match = asciiCaseEqual(str1, str2, len1);
 
-	free(str1);
-	free(str2);
+	free(tofree1);
+	free(tofree2);
 
 	return match;
 }
 
+/*	Frees the LDAPMessage of a capsule created by LDAPMessage2PyCapsule(). */
+static void
+free_message_capsule(PyObject *capsule) {
+	ldap_msgfree((LDAPMessage *)PyCapsule_GetPointer(capsule, "pyLDAP.LDAPMessage"));
+}
+
+/*	Wraps an LDAPMessage chain into a capsule, which frees the chain, when the capsule
+	is released. It keeps the messages alive for the lazy LDAPEntries.
+	On error, the message is freed, and NULL is returned. */
+PyObject *
+LDAPMessage2PyCapsule(LDAPMessage *msg) {
+	PyObject *capsule = PyCapsule_New(msg, "pyLDAP.LDAPMessage", free_message_capsule);
+
+	if (capsule == NULL) ldap_msgfree(msg);
+	return capsule;
+}
+
+/*	Allocates a new object of the `type` as PyType_GenericAlloc, but it takes the memory
+	from the `freelist` if it is possible. It can be the `tp_alloc` of the type. */
+PyObject *
+freelist_alloc(LDAPFreeList *freelist, PyTypeObject *type, Py_ssize_t nitems) {
+	PyObject *obj;
+
+	if (freelist->count == 0 || nitems != 0) return PyType_GenericAlloc(type, nitems);
+	obj = freelist->items[--freelist->count];
+	memset(obj, 0, type->tp_basicsize);
+	PyObject_Init(obj, type);
+	PyObject_GC_Track(obj);
+	return obj;
+}
+
+/*	Puts the memory of a deallocated object into the `freelist`, or releases it,
+	if the list is full. It can be the `tp_free` of the type. */
+void
+freelist_free(LDAPFreeList *freelist, void *obj) {
+	if (PyObject_GC_IsTracked((PyObject *)obj)) PyObject_GC_UnTrack(obj);
+	if (freelist->count < _LDAP_FREELIST_SIZE) {
+		freelist->items[freelist->count++] = (PyObject *)obj;
+	} else {
+		PyObject_GC_Del(obj);
+	}
+}
+
+/*	Releases the memory blocks of the `freelist`. */
+void
+freelist_clear(LDAPFreeList *freelist) {
+	while (freelist->count > 0) {
+		PyObject_GC_Del(freelist->items[--freelist->count]);
+	}
+}
+
+/*	Unpacks the arguments of a METH_FASTCALL (| METH_KEYWORDS) function into the `values`
+	array in the order of the NULL-terminated `kwlist` names, without creating a tuple and
+	a dict for them. The first `required` arguments are mandatory, the missing optional ones
+	are set to NULL. The `values` are borrowed references. Returns 0 on success, -1 otherwise.
+*/
+int
+unpack_args(const char *fname, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+		char **kwlist, int required, PyObject **values) {
+	Py_ssize_t i, j, max, nkw = 0;
+	PyObject *key;
+
+	for (max = 0; kwlist[max] != NULL; max++) values[max] = NULL;
+	if (nargs > max) {
+		PyErr_Format(PyExc_TypeError, "%s() takes at most %zd arguments (%zd given)",
+				fname, max, nargs);
+		return -1;
+	}
+	for (i = 0; i < nargs; i++) values[i] = args[i];
+
+	if (kwnames != NULL) nkw = PyTuple_GET_SIZE(kwnames);
+	for (i = 0; i < nkw; i++) {
+		key = PyTuple_GET_ITEM(kwnames, i);
+		for (j = 0; j < max; j++) {
+			if (PyUnicode_CompareWithASCIIString(key, kwlist[j]) == 0) break;
+		}
+		if (j == max) {
+			PyErr_Format(PyExc_TypeError, "%s() got an unexpected keyword argument '%U'",
+					fname, key);
+			return -1;
+		}
+		if (values[j] != NULL) {
+			PyErr_Format(PyExc_TypeError, "%s() got multiple values for argument '%s'",
+					fname, kwlist[j]);
+			return -1;
+		}
+		values[j] = args[nargs + i];
+	}
+
+	for (i = 0; i < required; i++) {
+		if (values[i] == NULL) {
+			PyErr_Format(PyExc_TypeError, "%s() missing required argument '%s'",
+					fname, kwlist[i]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*	Converts a string argument to UTF-8, like the "s" (or "z", if `nullable`) format of
+	PyArg_ParseTuple. The string belongs to the object. Returns 0 on success, -1 otherwise. */
+int
+arg2string(PyObject *obj, int nullable, char **str) {
+	Py_ssize_t len;
+
+	if (nullable && obj == Py_None) {
+		*str = NULL;
+		return 0;
+	}
+	if (!PyUnicode_Check(obj)) {
+		PyErr_Format(PyExc_TypeError, "str expected, not %.100s", Py_TYPE(obj)->tp_name);
+		return -1;
+	}
+	*str = (char *)PyUnicode_AsUTF8AndSize(obj, &len);
+	if (*str == NULL) return -1;
+	if ((Py_ssize_t)strlen(*str) != len) {
+		PyErr_SetString(PyExc_ValueError, "embedded null character");
+		return -1;
+	}
+	return 0;
+}
+
+/*	Converts an integer argument to int, like the "i" format of PyArg_ParseTuple.
+	Returns 0 on success, -1 otherwise. */
+int
+arg2int(PyObject *obj, int *num) {
+	long value;
+
+	if (PyFloat_Check(obj)) {
+		PyErr_SetString(PyExc_TypeError, "integer argument expected, got float");
+		return -1;
+	}
+	value = PyLong_AsLong(obj);
+	if (value == -1 && PyErr_Occurred()) return -1;
+	if (value > INT_MAX || value < INT_MIN) {
+		PyErr_SetString(PyExc_OverflowError, "signed integer is out of range");
+		return -1;
+	}
+	*num = (int)value;
+	return 0;
+}
+
 /*	Load the `object_name` Python object from the `module_name` Python module.
 	Returns the object or Py_None if it's failed.
  */
@@ -228,18 +693,137 @@ load_python_object(char *module_name, char *object_name) {
 	return object;
 }
 
+/* The names of the exceptions in the pyLDAP.errors module, which are cached. */
+static char *error_names[_LDAP_ERROR_NAMES] = {"LDAPError", "NotConnected", "InvalidDN",
+		"ConnectionError", "AuthenticationError"};
+
+/*	Visits the cached objects of the module's state for the garbage collector. */
+int
+traverse_module_state(pyLDAPState *state, visitproc visit, void *arg) {
+	int i;
+
+	Py_VISIT(state->ldapdn_type);
+	Py_VISIT(state->ldapurl_type);
+	Py_VISIT(state->get_error);
+	for (i = 0; i < _LDAP_ERROR_NAMES; i++) {
+		Py_VISIT(state->errors[i]);
+	}
+	for (i = 0; i <= _LDAP_MAX_RESULT_CODE - _LDAP_MIN_RESULT_CODE; i++) {
+		Py_VISIT(state->errors_by_code[i]);
+	}
+	return 0;
+}
+
+/*	Releases the cached objects of the module's state. */
+void
+clear_module_state(pyLDAPState *state) {
+	int i;
+
+	Py_CLEAR(state->ldapdn_type);
+	Py_CLEAR(state->ldapurl_type);
+	Py_CLEAR(state->get_error);
+	for (i = 0; i < _LDAP_ERROR_NAMES; i++) {
+		Py_CLEAR(state->errors[i]);
+	}
+	for (i = 0; i <= _LDAP_MAX_RESULT_CODE - _LDAP_MIN_RESULT_CODE; i++) {
+		Py_CLEAR(state->errors_by_code[i]);
+	}
+	state->codes_loaded = 0;
+}
+
+/*	Returns the `object_name` object of the `module_name` module (borrowed reference).
+	It is imported at the first call, and kept in the `slot` of the module's state.
+	Without module state (e.g. at interpreter shutdown), the `slot` is NULL,
+	and the object is imported, and returned as a new reference in `tmp`.
+*/
+static PyObject *
+cached_object(PyObject **slot, PyObject **tmp, char *module_name, char *object_name) {
+	*tmp = NULL;
+	if (slot == NULL) {
+		*tmp = load_python_object(module_name, object_name);
+		return *tmp;
+	}
+	if (*slot == NULL) *slot = load_python_object(module_name, object_name);
+	return *slot;
+}
+
+/*	Returns the LDAPDN type (borrowed reference), or NULL on error. */
+PyObject *
+get_ldapdn_type(void) {
+	PyObject *tmp, *obj;
+	pyLDAPState *state = get_module_state();
+
+	obj = cached_object(state ? &state->ldapdn_type : NULL, &tmp, "pyLDAP.ldapdn", "LDAPDN");
+	/* The type is kept alive by its module. */
+	Py_XDECREF(tmp);
+	return obj;
+}
+
+/*	Returns the LDAPURL type (borrowed reference), or NULL on error. */
+PyObject *
+get_ldapurl_type(void) {
+	PyObject *tmp, *obj;
+	pyLDAPState *state = get_module_state();
+
+	obj = cached_object(state ? &state->ldapurl_type : NULL, &tmp, "pyLDAP.ldapurl", "LDAPURL");
+	Py_XDECREF(tmp);
+	return obj;
+}
+
+/*	Returns the `error_name` exception class of the pyLDAP.errors module (new reference). */
 PyObject *
 get_error(char *error_name) {
-	return load_python_object("pyLDAP.errors", error_name);
+	int i;
+	PyObject *tmp, *obj;
+	pyLDAPState *state = get_module_state();
+
+	for (i = 0; i < _LDAP_ERROR_NAMES; i++) {
+		if (strcmp(error_names[i], error_name) == 0) break;
+	}
+	if (state == NULL || i == _LDAP_ERROR_NAMES) {
+		return load_python_object("pyLDAP.errors", error_name);
+	}
+	obj = cached_object(&state->errors[i], &tmp, "pyLDAP.errors", error_name);
+	Py_XINCREF(obj);
+	return obj;
 }
 
+/*	Fills the result code to exception table of the module's state with
+	the exceptions chosen by the pyLDAP.errors.get_error function.
+*/
+static int
+load_errors_by_code(pyLDAPState *state) {
+	int code;
+	PyObject *tmp, *func, *error;
+
+	func = cached_object(&state->get_error, &tmp, "pyLDAP.errors", "get_error");
+	if (func == NULL) return -1;
+	for (code = _LDAP_MIN_RESULT_CODE; code <= _LDAP_MAX_RESULT_CODE; code++) {
+		error = PyObject_CallFunction(func, "(i)", code);
+		if (error == NULL) return -1;
+		Py_XSETREF(state->errors_by_code[code - _LDAP_MIN_RESULT_CODE], error);
+	}
+	state->codes_loaded = 1;
+	return 0;
+}
+
+/*	Returns the exception class for the `code` LDAP result code (new reference). */
 PyObject *
 get_error_by_code(int code) {
-	PyObject *error;
-	PyObject *get_error = load_python_object("pyLDAP.errors", "get_error");
-	if (get_error == NULL) return NULL;
-
-	error = PyObject_CallFunction(get_error, "(i)", code);
+	PyObject *tmp, *func, *error;
+	pyLDAPState *state = get_module_state();
+
+	if (state != NULL && code >= _LDAP_MIN_RESULT_CODE && code <= _LDAP_MAX_RESULT_CODE) {
+		if (!state->codes_loaded && load_errors_by_code(state) != 0) return NULL;
+		error = state->errors_by_code[code - _LDAP_MIN_RESULT_CODE];
+		Py_INCREF(error);
+		return error;
+	}
+	/* Codes out of the table's range. */
+	func = cached_object(state ? &state->get_error : NULL, &tmp, "pyLDAP.errors", "get_error");
+	if (func == NULL) return NULL;
+	error = PyObject_CallFunction(func, "(i)", code);
+	Py_XDECREF(tmp);
 	return error;
 }
 
@@ -271,7 +855,9 @@ int _LDAP_initialization(LDAP **ld, PyObject *url) {
 	Py_DECREF(scheme);
 	if (ld == NULL) return -1;
 	ldap_set_option(*ld, LDAP_OPT_PROTOCOL_VERSION, &version);
+	Py_BEGIN_ALLOW_THREADS
 	rc = ldap_connect(*ld, NULL);
+	Py_END_ALLOW_THREADS
 	return rc;
 }
 
@@ -300,9 +886,13 @@ int _LDAP_bind_s(LDAP *ld, char *mech, char* binddn, char *pswstr, char *authcid
 			method = LDAP_AUTH_SASL;
 		}
 		// TODO: it's depricated. Should use ldap_sasl_bind_sA instead?
+		Py_BEGIN_ALLOW_THREADS
 		rc = ldap_bind_sA(ld, binddn, (PCHAR)&creds, method);
+		Py_END_ALLOW_THREADS
 	} else {
+		Py_BEGIN_ALLOW_THREADS
 		rc = ldap_simple_bind_sA(ld, binddn, pswstr);
+		Py_END_ALLOW_THREADS
 	}
 
 	return rc;
@@ -319,6 +909,16 @@ int ldap_whoami_s(LDAP *ld, struct berval **authzid, LDAPControl **sctrls, LDAPC
 	return rc;
 }
 
+int _LDAP_create_page_control(LDAP *ld, int page_size, struct berval *cookie, LDAPControl **ctrl) {
+	return ldap_create_page_control(ld, page_size, cookie, 0, ctrl);
+}
+
+int _LDAP_parse_page_control(LDAP *ld, LDAPControl **ctrls, struct berval **cookie) {
+	ULONG count;
+
+	return ldap_parse_page_control(ld, ctrls, &count, cookie);
+}
+
 #else
 
 int _LDAP_initialization(LDAP **ld, PyObject *url) {
@@ -351,7 +951,9 @@ int _LDAP_bind_s(LDAP *ld, char *mech, char* binddn, char *pswstr, char *authcid
 		if (pswstr == NULL) pswstr = "";
 		defaults = create_sasl_defaults(ld, mech, realm, authcid, pswstr, authzid);
 		if (defaults == NULL) return -1;
+		Py_BEGIN_ALLOW_THREADS
 		rc = ldap_sasl_interactive_bind_s(ld, binddn, mech, sctrlsp, NULL, LDAP_SASL_QUIET, sasl_interact, defaults);
+		Py_END_ALLOW_THREADS
 	} else {
 		if (pswstr == NULL) {
 			passwd.bv_len = 0;
@@ -359,7 +961,9 @@ int _LDAP_bind_s(LDAP *ld, char *mech, char* binddn, char *pswstr, char *authcid
 			passwd.bv_len = strlen(pswstr);
 		}
 		passwd.bv_val = pswstr;
+		Py_BEGIN_ALLOW_THREADS
 		rc = ldap_sasl_bind_s(ld, binddn, LDAP_SASL_SIMPLE, &passwd, sctrlsp, NULL, &servdata);
+		Py_END_ALLOW_THREADS
 	}
 	return rc;
 }
@@ -368,6 +972,34 @@ int _LDAP_unbind(LDAP *ld) {
 	return ldap_unbind_ext_s((ld), NULL, NULL);
 }
 
+int _LDAP_create_page_control(LDAP *ld, int page_size, struct berval *cookie, LDAPControl **ctrl) {
+	return ldap_create_page_control(ld, page_size, cookie, 0, ctrl);
+}
+
+/*	Gets the cookie from the paged results control of the server's response.
+	The `cookie` is NULL or must be freed with ber_bvfree(). */
+int _LDAP_parse_page_control(LDAP *ld, LDAPControl **ctrls, struct berval **cookie) {
+	int rc;
+	ber_int_t count;
+	struct berval value;
+	LDAPControl *ctrl;
+
+	*cookie = NULL;
+	ctrl = ldap_control_find(LDAP_CONTROL_PAGEDRESULTS, ctrls, NULL);
+	if (ctrl == NULL) return LDAP_CONTROL_NOT_FOUND;
+
+	rc = ldap_parse_pageresponse_control(ld, ctrl, &count, &value);
+	if (rc != LDAP_SUCCESS) return rc;
+
+	*cookie = ber_memalloc(sizeof(struct berval));
+	if (*cookie == NULL) {
+		ber_memfree(value.bv_val);
+		return LDAP_NO_MEMORY;
+	}
+	**cookie = value;
+	return LDAP_SUCCESS;
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 * The following three functions are copies from the OpenLDAP sasl.c source file.
 * Basically, they are used with the "it's working why should touch anything" principle,
@@ -16,6 +16,67 @@
 
 #endif
 
+/* SSE2 is a part of every x86-64 CPU. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _LDAP_SSE2
+#include <emmintrin.h>
+#endif
+
+/* The range of the result codes in the prebuilt code-to-exception table. */
+#define _LDAP_MIN_RESULT_CODE -20
+#define _LDAP_MAX_RESULT_CODE 0x7F
+#define _LDAP_ERROR_NAMES 5
+
+/* Python objects, which are resolved once, and kept in the module's state. */
+typedef struct {
+	PyObject *ldapdn_type;
+	PyObject *ldapurl_type;
+	PyObject *get_error;
+	PyObject *errors[_LDAP_ERROR_NAMES];
+	PyObject *errors_by_code[_LDAP_MAX_RESULT_CODE - _LDAP_MIN_RESULT_CODE + 1];
+	int codes_loaded;
+} pyLDAPState;
+
+/* Decoding policies of the attributes' values. */
+#define _LDAP_DECODE_AUTO 0
+#define _LDAP_DECODE_BYTES 1
+#define _LDAP_DECODE_STR 2
+/* Flag of the attributes, whose values are interned. */
+#define _LDAP_DECODE_INTERN 0x4
+#define _LDAP_DECODE_MASK 0x3
+
+/* The maximal number of the recycled objects of a type. */
+#define _LDAP_FREELIST_SIZE 1024
+
+/*	Memory blocks of the deallocated objects of a (not variable-sized, GC-tracked)
+	type, which are reused by the next allocations instead of the allocator. */
+typedef struct {
+	int count;
+	PyObject *items[_LDAP_FREELIST_SIZE];
+} LDAPFreeList;
+
+/* The size of the memory blocks of an LDAPArena. */
+#define _LDAP_ARENA_BLOCK_SIZE 4096
+
+typedef struct LDAPArenaBlock_s {
+	struct LDAPArenaBlock_s *next;
+	size_t size;
+	size_t used;
+} LDAPArenaBlock;
+
+/*	Memory of an LDAP operation (e.g. the LDAPMod list of a modify) allocated from
+	a few large blocks, and released at once by arena_free(). The `refs` list keeps
+	alive the Python objects, whose buffers are referenced without copying. */
+typedef struct {
+	LDAPArenaBlock *blocks;
+	PyObject *refs;
+} LDAPArena;
+
+/* PyObject_GC_IsTracked is public only since Python 3.9. */
+#if PY_VERSION_HEX < 0x03090000
+#define PyObject_GC_IsTracked(op) _PyObject_GC_IS_TRACKED(op)
+#endif
+
 typedef struct lutil_sasl_defaults_s {
 	char *mech;
 	char *realm;
@@ -27,20 +88,45 @@ typedef struct lutil_sasl_defaults_s {
 } lutilSASLdefaults;
 
 char *lowercase(char *str);
-struct berval *createBerval(char *value);
-PyObject *berval2PyObject(struct berval *bval);
-LDAPMod *createLDAPModFromItem(int mod_op, PyObject *key, PyObject *value);
+struct berval *createBerval(PyObject *obj, char **tofree);
+int isValidUTF8(const char *str, Py_ssize_t len);
+PyObject *berval2PyObject(struct berval *bval, int policy);
+LDAPMod *createLDAPModFromItem(LDAPArena *arena, int mod_op, PyObject *key, PyObject *value);
 char *PyObject2char(PyObject *obj);
-struct berval **PyList2BervalList(PyObject *list);
+const char *PyObject2buffer(PyObject *obj, Py_ssize_t *len, char **tofree);
+void arena_init(LDAPArena *arena);
+void *arena_alloc(LDAPArena *arena, size_t size);
+int arena_keep(LDAPArena *arena, PyObject *obj);
+const char *arena_buffer(LDAPArena *arena, PyObject *obj, Py_ssize_t *len);
+struct berval **arena_berval_list(LDAPArena *arena, PyObject *list);
+void arena_free(LDAPArena *arena);
 char **PyList2StringList(PyObject *list);
+void free_string_list(char **strlist);
+PyObject *LDAPMessage2PyCapsule(LDAPMessage *msg);
+PyObject *freelist_alloc(LDAPFreeList *freelist, PyTypeObject *type, Py_ssize_t nitems);
+void freelist_free(LDAPFreeList *freelist, void *obj);
+void freelist_clear(LDAPFreeList *freelist);
+int unpack_args(const char *fname, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+		char **kwlist, int required, PyObject **values);
+int arg2string(PyObject *obj, int nullable, char **str);
+int arg2int(PyObject *obj, int *num);
+int asciiCaseEqual(const char *s1, const char *s2, Py_ssize_t len);
 int lowerCaseMatch(PyObject *o1, PyObject *o2);
+Py_ssize_t parse_attr_range(const char *attr, Py_ssize_t len, Py_ssize_t *next);
 PyObject *load_python_object(char *module_name, char *object_name);
+pyLDAPState *get_module_state(void);
+int traverse_module_state(pyLDAPState *state, visitproc visit, void *arg);
+void clear_module_state(pyLDAPState *state);
+PyObject *get_ldapdn_type(void);
+PyObject *get_ldapurl_type(void);
 PyObject *get_error(char *error_name);
 PyObject *get_error_by_code(int code);
 
 int _LDAP_initialization(LDAP **ld, PyObject *url);
 int _LDAP_bind_s(LDAP *ld, char *mech, char* binddn, char *pswstr, char *authcid, char *realm, char *authzid);
 int _LDAP_unbind(LDAP *ld);
+int _LDAP_create_page_control(LDAP *ld, int page_size, struct berval *cookie, LDAPControl **ctrl);
+int _LDAP_parse_page_control(LDAP *ld, LDAPControl **ctrls, struct berval **cookie);
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
 
@@ -0,0 +1,134 @@
+#include "utils.h"
+
+#include "valuecache.h"
+
+#define VALUECACHE_MINSIZE 64
+
+/*	Calculates the FNV-1a hash of the `len` long `str`. */
+static Py_hash_t
+value_hash(const char *str, Py_ssize_t len, int policy) {
+	Py_ssize_t i;
+	size_t hash = (size_t)14695981039346656037ULL ^ (size_t)policy;
+
+	for (i = 0; i < len; i++) {
+		hash = (hash ^ (unsigned char)str[i]) * (size_t)1099511628211ULL;
+	}
+	return (Py_hash_t)hash;
+}
+
+/*	Releases the cached values. The statistics are reset too. */
+void
+ValueCache_Clear(ValueCache *cache) {
+	Py_ssize_t i;
+
+	for (i = 0; i < cache->size; i++) {
+		Py_XDECREF(cache->table[i].value);
+	}
+	free(cache->table);
+	memset(cache, 0, sizeof(ValueCache));
+}
+
+/*	Doubles the size of the table. Returns 0 on success, -1 otherwise. */
+static int
+grow(ValueCache *cache) {
+	Py_ssize_t i, j;
+	Py_ssize_t size = (cache->size == 0) ? VALUECACHE_MINSIZE : cache->size * 2;
+	ValueCacheEntry *table;
+
+	table = (ValueCacheEntry *)calloc(size, sizeof(ValueCacheEntry));
+	if (table == NULL) {
+		PyErr_NoMemory();
+		return -1;
+	}
+	for (i = 0; i < cache->size; i++) {
+		if (cache->table[i].value == NULL) continue;
+		for (j = (size_t)cache->table[i].hash & (size - 1); table[j].value != NULL;
+				j = (j + 1) & (size - 1));
+		table[j] = cache->table[i];
+	}
+	free(cache->table);
+	cache->table = table;
+	cache->size = size;
+	return 0;
+}
+
+/*	Stores the `value` decoded from the `bval` in the `slot`. Only those values
+	are cached, whose buffer is the same as the raw BER value, because that's
+	what the lookup compares. Returns 0 on success (even if the value is not cached),
+	-1 otherwise. */
+static int
+store(ValueCache *cache, ValueCacheEntry *slot, Py_hash_t hash, struct berval *bval,
+		int policy, PyObject *value) {
+	const char *str;
+	Py_ssize_t len;
+	PyObject *size;
+
+	if (PyBytes_Check(value)) {
+		str = PyBytes_AS_STRING(value);
+		len = PyBytes_GET_SIZE(value);
+	} else {
+		str = PyUnicode_AsUTF8AndSize(value, &len);
+		if (str == NULL) return -1;
+		/* Replaced invalid UTF-8 sequences. */
+		if (len != (Py_ssize_t)bval->bv_len || memcmp(str, bval->bv_val, len) != 0) return 0;
+	}
+	size = PyObject_CallMethod(value, "__sizeof__", NULL);
+	if (size == NULL) return -1;
+	slot->objsize = PyLong_AsSsize_t(size);
+	Py_DECREF(size);
+	slot->hash = hash;
+	slot->policy = policy;
+	slot->str = str;
+	slot->len = len;
+	Py_INCREF(value);
+	slot->value = value;
+	cache->used++;
+	return 0;
+}
+
+/*	Returns the decoded form (new reference) of the `bval` value with the `policy`.
+	A repeated value is returned from the cache, a new one is decoded and cached,
+	if it is short enough, and the cache is not full yet.
+*/
+PyObject *
+ValueCache_Get(ValueCache *cache, struct berval *bval, int policy) {
+	Py_hash_t hash;
+	Py_ssize_t i, mask;
+	PyObject *value;
+	ValueCacheEntry *slot;
+
+	if ((Py_ssize_t)bval->bv_len > _LDAP_VALUECACHE_MAXLEN) return berval2PyObject(bval, policy);
+	if (cache->used * 3 >= cache->size * 2 && cache->used < _LDAP_VALUECACHE_MAXSIZE) {
+		if (grow(cache) != 0) return NULL;
+	}
+	hash = value_hash(bval->bv_val, bval->bv_len, policy);
+	mask = cache->size - 1;
+	for (i = (size_t)hash & mask; ; i = (i + 1) & mask) {
+		slot = &cache->table[i];
+		if (slot->value == NULL) break;
+		if (slot->hash == hash && slot->policy == policy && slot->len == (Py_ssize_t)bval->bv_len
+				&& memcmp(slot->str, bval->bv_val, slot->len) == 0) {
+			cache->hits++;
+			cache->saved += slot->objsize;
+			Py_INCREF(slot->value);
+			return slot->value;
+		}
+	}
+
+	cache->misses++;
+	value = berval2PyObject(bval, policy);
+	if (value == NULL) return NULL;
+	if (cache->used < _LDAP_VALUECACHE_MAXSIZE && store(cache, slot, hash, bval, policy, value) != 0) {
+		Py_DECREF(value);
+		return NULL;
+	}
+	return value;
+}
+
+/*	Returns a dict of the cache's statistics: the number of the cached values, the
+	hits and misses of the lookups, and the memory saved by the hits (in bytes). */
+PyObject *
+ValueCache_Stats(ValueCache *cache) {
+	return Py_BuildValue("{s:n,s:n,s:n,s:n}", "values", cache->used, "hits", cache->hits,
+			"misses", cache->misses, "saved_bytes", cache->saved);
+}
@@ -0,0 +1,49 @@
+#ifndef VALUECACHE_H_
+#define VALUECACHE_H_
+
+#include <Python.h>
+
+//MS Windows
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+
+#include <windows.h>
+#include <winldap.h>
+
+//Unix
+#else
+#include <lber.h>
+
+#endif
+
+/* The bounds of the cache: the number of the values and the length of a value. */
+#define _LDAP_VALUECACHE_MAXSIZE 65536
+#define _LDAP_VALUECACHE_MAXLEN 128
+
+typedef struct {
+	Py_hash_t hash;
+	int policy;
+	const char *str;
+	Py_ssize_t len;
+	Py_ssize_t objsize;
+	PyObject *value;
+} ValueCacheEntry;
+
+/*	Open-addressing hash table of the decoded values of the interned attributes,
+	keyed by their raw BER form and decoding policy. Repeated values are returned
+	as the same Python object. New values are not added after the cache is full.
+	A zero-filled ValueCache is a valid empty cache.
+*/
+typedef struct {
+	Py_ssize_t size;
+	Py_ssize_t used;
+	Py_ssize_t hits;
+	Py_ssize_t misses;
+	Py_ssize_t saved;
+	ValueCacheEntry *table;
+} ValueCache;
+
+void ValueCache_Clear(ValueCache *cache);
+PyObject *ValueCache_Get(ValueCache *cache, struct berval *bval, int policy);
+PyObject *ValueCache_Stats(ValueCache *cache);
+
+#endif /* VALUECACHE_H_ */
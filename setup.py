@@ -4,9 +4,15 @@ from distutils.core import setup, Extension
 
 sources = ["pyldapmodule.c", "ldapentry.c", 
            "ldapclient.c", "ldapvaluelist.c", 
-           "utils.c", "uniquelist.c"]
+           "utils.c", "uniquelist.c", "ldapsearchiter.c",
+           "caseindex.c", "ldapfrozenentry.c",
+           "attrlayout.c", "valuecache.c", "ldapresultset.c",
+           "ldapvalueiter.c"]
 
-depends = ["ldapclient.h", "ldapvaluelist.h", "uniquelist.h", "utils.h"]
+depends = ["ldapclient.h", "ldapvaluelist.h", "uniquelist.h", "utils.h",
+           "ldapsearchiter.h", "caseindex.h", "ldapfrozenentry.h",
+           "attrlayout.h", "valuecache.h", "ldapresultset.h",
+           "ldapvalueiter.h"]
 
 sources = [ os.path.join('pyLDAP', x) for x in sources]
 depends = [ os.path.join('pyLDAP', x) for x in depends]
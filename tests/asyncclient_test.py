@@ -0,0 +1,77 @@
+import asyncio
+import unittest
+
+from pyLDAP import LDAPClient
+from pyLDAP import LDAPEntry
+from pyLDAP.asyncclient import AsyncLDAPClient
+import pyLDAP.errors
+
+class AsyncLDAPClientTest(unittest.TestCase):
+    def setUp(self):
+        self.url = "ldap://192.168.1.83/dc=local?cn?sub"
+        self.loop = asyncio.new_event_loop()
+        self.client = AsyncLDAPClient(self.url, loop=self.loop)
+        self.loop.run_until_complete(self.client.connect("cn=admin,dc=local", "p@ssword"))
+
+    def tearDown(self):
+        self.loop.run_until_complete(self.client.close())
+        self.loop.close()
+        del self.client
+
+    def run_async(self, coro):
+        return self.loop.run_until_complete(coro)
+
+    def test_search(self):
+        o = self.run_async(self.client.search("dc=local", 2))
+        self.assertEqual(o, self.client.client.search("dc=local", 2))
+
+    def test_concurrent(self):
+        async def gather():
+            return await asyncio.gather(*[self.client.get_entry("cn=admin,dc=local")
+                                          for _ in range(100)])
+        o = self.run_async(gather())
+        self.assertEqual(len(o), 100)
+        for entry in o:
+            self.assertIsInstance(entry, LDAPEntry)
+
+    def test_whoami(self):
+        o = self.run_async(self.client.whoami())
+        self.assertEqual(o, "dn:cn=admin,dc=local")
+
+    def test_compare(self):
+        self.assertTrue(self.run_async(self.client.compare("cn=admin,dc=local", "cn", "admin")))
+        self.assertFalse(self.run_async(self.client.compare("cn=admin,dc=local", "cn", "nobody")))
+
+    def test_operations(self):
+        entry = LDAPEntry("cn=async,dc=local", self.client.client)
+        entry['objectclass'] = ['top', 'inetOrgPerson', 'person', 'organizationalPerson']
+        entry['sn'] = "Async"
+        self.run_async(self.client.add(entry))
+        entry['sn'] = "Async_modify"
+        self.run_async(self.client.modify(entry))
+        self.run_async(self.client.rename(entry, "cn=async2,dc=local"))
+        o = self.run_async(self.client.get_entry("cn=async2,dc=local"))
+        self.assertEqual(o['sn'], ["Async_modify"])
+        self.run_async(self.client.delete("cn=async2,dc=local"))
+        self.assertRaises(pyLDAP.errors.LDAPError, self.run_async,
+                          self.client.delete("cn=async2,dc=local"))
+
+    def test_foreign_entry(self):
+        client = LDAPClient(self.url)
+        client.connect("cn=admin,dc=local", "p@ssword")
+        try:
+            entry = LDAPEntry("cn=async,dc=local", client)
+            entry['objectclass'] = ['top', 'inetOrgPerson', 'person', 'organizationalPerson']
+            entry['sn'] = "Async"
+            self.assertRaises(ValueError, self.run_async, self.client.add(entry))
+            self.assertRaises(ValueError, self.run_async, self.client.modify(entry))
+            self.assertRaises(ValueError, self.run_async,
+                              self.client.rename(entry, "cn=async2,dc=local"))
+            self.assertRaises(ValueError, self.run_async,
+                              self.client.add(LDAPEntry("cn=async,dc=local")))
+            self.assertIsNone(self.run_async(self.client.get_entry("cn=async,dc=local")))
+        finally:
+            client.close()
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,9 +1,19 @@
+import gc
+import threading
+import time
 import unittest
+import weakref
 
 from pyLDAP import LDAPClient
+from pyLDAP import LDAPDN
 from pyLDAP import LDAPEntry
+from pyLDAP import LDAPFrozenEntry
+from pyLDAP import LDAPResultSet
+from pyLDAP import LDAPURL
 import pyLDAP.errors
 
+from rangeserver import RangeServer
+
 class LDAPClientTest(unittest.TestCase):
     def setUp(self):
         self.url = "ldap://192.168.1.83/dc=local?cn?sub"
@@ -29,6 +39,19 @@ class LDAPClientTest(unittest.TestCase):
         self.assertIsNotNone(o)
         self.assertEqual(o, self.client.search())
         
+    def test_search_iter(self):
+        o = list(self.client.search_iter("dc=local", 2, page_size=2))
+        self.assertEqual(len(o), len(self.client.search("dc=local", 2)))
+        self.assertEqual(o, self.client.search("dc=local", 2, page_size=3))
+
+    def test_search_stream(self):
+        it = self.client.search_iter("dc=local", 2, page_size=0)
+        self.assertIsInstance(next(it), LDAPEntry)
+        it.close()
+        self.assertEqual(list(it), [])
+        o = list(self.client.search_iter("dc=local", 2, page_size=0))
+        self.assertEqual(len(o), len(self.client.search("dc=local", 2)))
+
     def test_rootdse(self):
         self.assertEqual(self.client.get_rootDSE()['supportedLDAPVersion'], ["3"])
  
@@ -39,7 +62,331 @@ class LDAPClientTest(unittest.TestCase):
     def test_whoami(self):
         o = self.client.whoami()
         self.assertEqual(o, "dn:cn=admin,dc=local")
- 
+
+    def test_threads(self):
+        results = []
+        def search():
+            client = LDAPClient(self.url)
+            client.connect("cn=admin,dc=local", "p@ssword")
+            for _ in range(10):
+                results.append(len(client.search()))
+            client.close()
+        threads = [threading.Thread(target=search) for _ in range(8)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(len(results), 80)
+        self.assertEqual(len(set(results)), 1)
+
+    def test_close(self):
+        client = LDAPClient(self.url)
+        client.connect("cn=admin,dc=local", "p@ssword")
+        client.close()
+        client.close()
+        self.assertRaises(pyLDAP.errors.NotConnected, client.search)
+
+    def test_close_during_call(self):
+        client = LDAPClient(self.url)
+        client.connect("cn=admin,dc=local", "p@ssword")
+        class ClosingURL(LDAPURL):
+            # Closes the client while the search's arguments are parsed.
+            @property
+            def filter(self):
+                client.close()
+                return None
+        client.url = ClosingURL(self.url)
+        self.assertRaises(pyLDAP.errors.NotConnected, client.search)
+        client.connect("cn=admin,dc=local", "p@ssword")
+        self.assertRaises(pyLDAP.errors.NotConnected, client.search_iter, page_size=2)
+        client.connect("cn=admin,dc=local", "p@ssword")
+        self.assertRaises(pyLDAP.errors.NotConnected, client.send_search)
+
+    def test_pipeline(self):
+        entry = self.client.get_entry("cn=admin,dc=local")
+        msgids = [self.client.send_search() for _ in range(10)]
+        msgids.append(self.client.send_whoami())
+        msgids.append(self.client.send_compare("cn=admin,dc=local", "cn", "admin"))
+        self.assertEqual(self.client.pending, frozenset(msgids))
+        ready = []
+        while len(ready) < len(msgids):
+            ready.extend(self.client.poll())
+        self.assertEqual(sorted(ready), sorted(msgids))
+        self.assertEqual(self.client.pending, frozenset())
+        results = [self.client.result(msgid) for msgid in msgids]
+        self.assertEqual(results[0], self.client.search())
+        self.assertEqual(len(set(len(res) for res in results[:10])), 1)
+        self.assertEqual(results[10], "dn:cn=admin,dc=local")
+        self.assertTrue(results[11])
+        self.assertIsInstance(entry, LDAPEntry)
+        # The collected and the unknown ids do not block, while others are pending.
+        msgid = self.client.send_search()
+        self.assertRaises(ValueError, self.client.result, msgids[0])
+        self.assertRaises(ValueError, self.client.result, 99999)
+        self.assertEqual(self.client.result(msgid), results[0])
+
+    def test_decode_policy(self):
+        self.assertEqual(self.client.get_decode_policy("cn"), "auto")
+        self.assertEqual(self.client.get_decode_policy("jpegPhoto"), "bytes")
+        self.assertEqual(self.client.get_decode_policy("description;binary"), "bytes")
+        self.assertRaises(ValueError, self.client.set_decode_policy, "cn", "text")
+        entry = LDAPEntry("cn=test,dc=local", self.client)
+        entry['objectclass'] = ['top', 'inetOrgPerson', 'person', 'organizationalPerson']
+        entry['sn'] = "Test"
+        entry['description'] = "Árvíztűrő tükörfúrógép"
+        entry['jpegPhoto'] = b"\xffbinary"
+        entry.add()
+        try:
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(obj['description'], ["Árvíztűrő tükörfúrógép"])
+            self.assertEqual(obj['jpegPhoto'], [b"\xffbinary"])
+            self.client.set_decode_policy("Description", "bytes")
+            self.client.set_decode_policy("jpegPhoto", "str")
+            self.assertEqual(self.client.get_decode_policy("description"), "bytes")
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(obj['description'], ["Árvíztűrő tükörfúrógép".encode()])
+            self.assertEqual(obj['jpegPhoto'], ["\ufffdbinary"])
+        finally:
+            entry.delete()
+
+    def test_lazy_search(self):
+        eager = self.client.search("dc=local", 2, attrlist=["*"])
+        lazy = self.client.search("dc=local", 2, attrlist=["*"], lazy=True)
+        self.assertEqual([len(obj) for obj in lazy], [len(obj) for obj in eager])
+        self.assertTrue("objectClass" in lazy[0])
+        self.assertEqual(lazy[0]['ObjectClass'], eager[0]['objectClass'])
+        self.assertEqual(lazy, eager)
+        it = self.client.search_iter("dc=local", 2, attrlist=["*"], page_size=2, lazy=True)
+        self.assertEqual(list(it), eager)
+        it = self.client.search_iter("dc=local", 2, attrlist=["*"], page_size=0, lazy=True)
+        self.assertEqual(list(it), eager)
+        msgid = self.client.send_search("dc=local", 2, attrlist=["*"], lazy=True)
+        self.assertEqual(self.client.result(msgid), eager)
+
+    def test_lazy_modify(self):
+        entry = LDAPEntry("cn=test,dc=local", self.client)
+        entry['objectclass'] = ['top', 'inetOrgPerson', 'person', 'organizationalPerson']
+        entry['sn'] = "Test"
+        entry['description'] = "first"
+        entry.add()
+        try:
+            obj = self.client.search("cn=test,dc=local", 0, attrlist=["*"], lazy=True)[0]
+            obj['Description'].append("second")
+            obj.modify()
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(sorted(obj['description']), ["first", "second"])
+            self.assertEqual(obj['sn'], ["Test"])
+            self.assertEqual(len(obj['objectClass']), 4)
+        finally:
+            entry.delete()
+
+    def test_modify_values(self):
+        entry = LDAPEntry("cn=test,dc=local", self.client)
+        entry['objectclass'] = ['top', 'inetOrgPerson', 'person', 'organizationalPerson']
+        entry['sn'] = "Test"
+        entry['description'] = ["value%d" % i for i in range(10)]
+        entry.add()
+        try:
+            self.client.modify_values("cn=test,dc=local", "description",
+                                      add=["new%d" % i for i in range(10)],
+                                      remove=["value0", "value1"])
+            self.client.modify_values("cn=test,dc=local", "description", remove=[])
+            # The existing, missing and duplicated values are ignored.
+            self.client.modify_values("cn=test,dc=local", "description",
+                                      add=["new0", "value9", "NEW0"],
+                                      remove=["value0", "missing", "missing"])
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(len(obj['description']), 18)
+            self.assertIn("new9", obj['description'])
+            self.assertNotIn("value0", obj['description'])
+            obj['description'].add_values(["value0", "new0", "VALUE2"])
+            obj['description'].remove_values(["new1", "new2", "missing"])
+            obj.modify()
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(len(obj['description']), 17)
+            self.assertIn("value0", obj['description'])
+            self.assertNotIn("new1", obj['description'])
+        finally:
+            entry.delete()
+
+    def test_ranged_values(self):
+        entry = LDAPEntry("cn=test,dc=local", self.client)
+        entry['objectclass'] = ['top', 'inetOrgPerson', 'person', 'organizationalPerson']
+        entry['sn'] = "Test"
+        entry['description'] = ["value%d" % i for i in range(5000)]
+        entry.add()
+        try:
+            # OpenLDAP sends every value at once, the ranged replies are
+            # tested by LDAPRangedValuesTest.
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(len(obj['description']), 5000)
+            self.assertIn("value4999", obj['description'])
+            self.assertNotIn(";", "".join(obj.keys()))
+            values = self.client.iter_values("cn=test,dc=local", "description")
+            self.assertEqual(sorted(values), sorted(entry['description']))
+            self.assertEqual(list(self.client.iter_values("cn=test,dc=local", "mail")), [])
+        finally:
+            entry.delete()
+
+    def test_frozen_search(self):
+        eager = self.client.search("dc=local", 2, attrlist=["*"])
+        frozen = self.client.search("dc=local", 2, attrlist=["*"], frozen=True)
+        self.assertEqual(len(frozen), len(eager))
+        obj = frozen[0]
+        self.assertIsInstance(obj, LDAPFrozenEntry)
+        self.assertEqual(obj.dn, str(eager[0].dn))
+        self.assertEqual(obj['ObjectClass'], tuple(eager[0]['objectClass']))
+        self.assertEqual(obj.get('ObjectClass'), obj['objectClass'])
+        self.assertIsNone(obj.get('nonexistent'))
+        self.assertEqual(obj.get('nonexistent', ()), ())
+        self.assertIn('OBJECTCLASS', obj)
+        self.assertNotIn('nonexistent', obj)
+        self.assertEqual({key: list(val) for key, val in obj.items()}, eager[0])
+        self.assertRaises(TypeError, obj.__setitem__, "cn", "test")
+        self.assertRaises(TypeError, obj.__delitem__, "objectClass")
+        self.assertRaises(TypeError, obj.update, {"cn": "test"})
+        entry = obj.to_entry()
+        self.assertIsInstance(entry, LDAPEntry)
+        self.assertEqual(entry, eager[0])
+        self.assertEqual(entry.dn, eager[0].dn)
+        it = self.client.search_iter("dc=local", 2, attrlist=["*"], page_size=2, frozen=True)
+        self.assertEqual(list(it), frozen)
+        msgid = self.client.send_search("dc=local", 2, attrlist=["*"], frozen=True)
+        self.assertEqual(self.client.result(msgid), frozen)
+
+    def test_columnar_search(self):
+        eager = self.client.search("dc=local", 2, attrlist=["*"])
+        res = self.client.search("dc=local", 2, attrlist=["*"], columnar=True)
+        self.assertIsInstance(res, LDAPResultSet)
+        self.assertEqual(len(res), len(eager))
+        row = res[0]
+        self.assertEqual(row.dn, str(eager[0].dn))
+        self.assertEqual(row['ObjectClass'], tuple(eager[0]['objectClass']))
+        self.assertEqual({key: list(row[key]) for key in row}, eager[0])
+        self.assertEqual(row.to_entry(), eager[0])
+        self.assertEqual([row.dn for row in res], [str(obj.dn) for obj in eager])
+        rows, offsets, data = res.column("objectclass")
+        self.assertEqual(len(rows), len(res) + 1)
+        first = [bytes(data[offsets[i]:offsets[i + 1]]).decode()
+                 for i in range(rows[0], rows[1])]
+        self.assertEqual(first, list(eager[0]["objectClass"]))
+        self.assertTrue(data.readonly)
+        offsets, data = res.dn_column()
+        self.assertEqual(bytes(data[offsets[0]:offsets[1]]).decode(), row.dn)
+        self.assertRaises(KeyError, res.column, "nonexistent")
+        self.assertRaises(ValueError, self.client.search, "dc=local", 2, page_size=2,
+                          columnar=True)
+        msgid = self.client.send_search("dc=local", 2, attrlist=["*"], columnar=True)
+        self.assertEqual(len(self.client.result(msgid)), len(res))
+
+    def test_result_cycle(self):
+        class WeakURL(LDAPURL):
+            pass
+        client = LDAPClient(self.url)
+        client.url = WeakURL(self.url)
+        url = weakref.ref(client.url)
+        client.connect("cn=admin,dc=local", "p@ssword")
+        # The collected results refer back to the client.
+        msgids = [client.send_search("dc=local", 2, columnar=True), client.send_search()]
+        ready = []
+        while len(ready) < len(msgids):
+            ready.extend(client.poll())
+        del client
+        gc.collect()
+        self.assertIsNone(url())
+
+    def test_untracked_search(self):
+        eager = self.client.search("dc=local", 2, attrlist=["*"])
+        for kwds in ({}, {"lazy": True}, {"frozen": True}):
+            res = self.client.search("dc=local", 2, attrlist=["*"], untracked=True, **kwds)
+            self.assertEqual([dict(obj) for obj in res], [dict(obj) for obj in
+                             self.client.search("dc=local", 2, attrlist=["*"], **kwds)])
+            self.assertFalse(any(gc.is_tracked(obj) for obj in res))
+            self.assertFalse(any(gc.is_tracked(val) for val in res[0].values()))
+        res = self.client.search("dc=local", 2, attrlist=["*"], untracked=True)
+        self.assertEqual(res, eager)
+        values = res[0]["objectClass"]
+        values.append(LDAPDN("cn=test"))
+        self.assertTrue(gc.is_tracked(values))
+        res[0]["cn"] = ["test"]
+        self.assertTrue(gc.is_tracked(res[0]))
+
+    def test_shared_names(self):
+        for kwds in ({}, {"lazy": True}, {"frozen": True}):
+            res = self.client.search("dc=local", 2, attrlist=["objectClass"], **kwds)
+            names = [obj.attributes[0] for obj in res]
+            self.assertTrue(all(name is names[0] for name in names))
+            self.assertTrue(all(obj["OBJECTCLASS"] for obj in res))
+
+    def test_value_interning(self):
+        self.client.set_value_interning("objectClass")
+        self.client.set_decode_policy("ObjectClass", "str")
+        self.assertEqual(self.client.get_decode_policy("objectclass"), "str")
+        for kwds in ({}, {"lazy": True}, {"frozen": True}):
+            res = self.client.search("dc=local", 2, attrlist=["objectClass"], **kwds)
+            values = {}
+            for obj in res:
+                for val in obj["objectClass"]:
+                    self.assertIs(values.setdefault(val, val), val)
+        stats = self.client.get_interning_stats()
+        self.assertGreater(stats["hits"], 0)
+        self.assertGreater(stats["saved_bytes"], 0)
+        self.assertEqual(stats["values"], len(values))
+        self.client.set_value_interning("objectClass", False)
+        self.client.clear_interning_cache()
+        self.client.search("dc=local", 2, attrlist=["objectClass"])
+        self.assertEqual(self.client.get_interning_stats()["values"], 0)
+        self.assertEqual(self.client.get_decode_policy("objectclass"), "str")
+
+class LDAPRangedValuesTest(unittest.TestCase):
+    """ Test the ranged retrieval against a server, that sends the values
+    of the member attribute in ranges of 10 values. """
+    def setUp(self):
+        self.dn = "cn=group,dc=local"
+        self.members = ["cn=user%d,dc=local" % i for i in range(25)]
+        self.server = RangeServer(self.dn, "member", self.members, 10)
+        self.client = LDAPClient("ldap://127.0.0.1:%d" % self.server.port)
+        self.client.connect()
+
+    def tearDown(self):
+        self.client.close()
+        self.server.close()
+
+    def test_get_entry(self):
+        obj = self.client.get_entry(self.dn)
+        self.assertEqual(obj['member'], self.members)
+        self.assertEqual(sorted(obj.keys()), ["member", "objectClass"])
+        self.assertEqual(self.server.searches, [[], ["member;range=10-*"],
+                                                ["member;range=20-*"]])
+        obj.modify()
+        self.assertEqual(self.server.mods, [])
+
+    def test_iter_values(self):
+        values = self.client.iter_values(self.dn, "member")
+        self.assertEqual(next(values), self.members[0])
+        # The next range is requested before the values of the first one are consumed.
+        for _ in range(50):
+            if len(self.server.searches) == 2:
+                break
+            time.sleep(0.1)
+        self.assertEqual(self.server.searches, [["member"], ["member;range=10-*"]])
+        self.assertEqual(list(values), self.members[1:])
+        self.assertEqual(len(self.server.searches), 3)
+
+    def test_server_down(self):
+        values = self.client.iter_values(self.dn, "member")
+        self.assertEqual(next(values), self.members[0])
+        self.server.close()
+        self.assertRaises(pyLDAP.errors.ConnectionError, list, values)
+
+    def test_server_down_sync(self):
+        obj = self.client.get_entry(self.dn)
+        obj['member'].append("cn=new,dc=local")
+        self.server.close()
+        self.assertRaises(pyLDAP.errors.ConnectionError, self.client.get_entry, self.dn)
+        self.assertRaises(pyLDAP.errors.ConnectionError, obj.modify)
+        self.assertRaises(pyLDAP.errors.ConnectionError, self.client.del_entry, self.dn)
+
 if __name__ == '__main__':
     unittest.main()   
     
\ No newline at end of file
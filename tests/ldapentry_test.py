@@ -57,6 +57,106 @@ class LDAPEntryTest(unittest.TestCase):
         del self.entry['mAil']
         self.assertRaises(KeyError, self.get_mail)
         
+    def test_many_attributes(self):
+        for i in range(300):
+            self.entry['Attr%d' % i] = "value%d" % i
+        for i in range(300):
+            self.assertEqual(self.entry['aTTR%d' % i], ["value%d" % i])
+        for i in range(0, 300, 2):
+            del self.entry['ATTR%d' % i]
+        self.assertRaises(KeyError, lambda: self.entry['attr0'])
+        self.assertEqual(self.entry['attr299'], ["value299"])
+        self.entry['ATTR0'] = "new"
+        self.assertIn("ATTR0", self.entry.attributes)
+        self.assertEqual(self.entry['attr0'], ["new"])
+        self.assertEqual(len(self.entry), 153)
+
+    def test_many_values(self):
+        self.entry['member'] = ["uid=user%d,dc=local" % i for i in range(20000)]
+        members = self.entry['member']
+        self.assertIn("UID=USER19999,DC=LOCAL", members)
+        self.assertRaises(ValueError, members.append, "uid=User0,dc=local")
+        members.remove("UID=user1,dc=local")
+        self.assertNotIn("uid=user1,dc=local", members)
+        self.assertEqual(members.pop(), "uid=user19999,dc=local")
+        self.assertNotIn("uid=user19999,dc=local", members)
+        members[0] = "UID=USER0,DC=LOCAL"
+        self.assertEqual(members[0], "UID=USER0,DC=LOCAL")
+        members.clear()
+        self.assertNotIn("uid=user0,dc=local", members)
+        members.append("uid=user0,dc=local")
+        self.assertEqual(members, ["uid=user0,dc=local"])
+
+    def test_value_types(self):
+        self.entry['description'] = [b"Binary", 1, "Árvíztűrő Tükörfúrógép x"]
+        values = self.entry['description']
+        self.assertIn(b"BINARY", values)
+        self.assertIn("1", values)
+        # Only the ASCII letters are case-insensitive.
+        self.assertIn("Árvíztűrő Tükörfúrógép X", values)
+        self.assertNotIn("árvíztűrő tükörfúrógép x", values)
+
+    def test_utf8_values(self):
+        self.entry['description'] = ["Árvíztűrő tükörfúrógép", bytearray(b"bytes-like")]
+        self.entry['jpegPhoto'] = b"\x00\xff\x10binary\x00"
+        self.entry.add()
+        try:
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertIn("Árvíztűrő tükörfúrógép", obj['description'])
+            self.assertIn("bytes-like", obj['description'])
+            self.assertEqual(obj['jpegPhoto'], [b"\x00\xff\x10binary\x00"])
+            msgid = self.client.send_compare("cn=test,dc=local", "description",
+                                             "Árvíztűrő tükörfúrógép")
+            self.assertTrue(self.client.result(msgid))
+        finally:
+            self.entry.delete()
+
+    def test_modify_values(self):
+        self.entry.add()
+        try:
+            self.entry['description'] = [b"bytes", "str", bytearray(b"bytes-like"), 42]
+            self.entry['mail'] = ["user%d@mail" % i for i in range(1000)]
+            self.entry.modify()
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(sorted(obj['description']), ["42", "bytes", "bytes-like", "str"])
+            self.assertEqual(len(obj['mail']), 1000)
+            self.entry['mail'].remove("user0@mail")
+            del self.entry['description']
+            self.entry.modify()
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertNotIn("description", obj)
+            self.assertNotIn("user0@mail", obj['mail'])
+        finally:
+            self.entry.delete()
+
+    def test_reassign_values(self):
+        self.entry['description'] = ["value%d" % i for i in range(100)]
+        self.entry.add()
+        try:
+            obj = self.client.get_entry("cn=test,dc=local")
+            values = ["value%d" % i for i in range(1, 100)] + ["new"]
+            obj['description'] = values
+            obj.modify()
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(sorted(obj['description']), sorted(values))
+            # A change in case only is sent as a replace.
+            obj['description'] = ["VALUE1"] + values[1:]
+            obj.modify()
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertIn("VALUE1", list(obj['description']))
+            obj['description'] = ["other"]
+            obj.modify()
+            obj = self.client.get_entry("cn=test,dc=local")
+            self.assertEqual(obj['description'], ["other"])
+        finally:
+            self.entry.delete()
+
+    def test_set_errors(self):
+        self.assertRaises(TypeError, self.entry.__setitem__, "description", ["a", "A"])
+        self.assertNotIn("description", self.entry)
+        self.assertRaises(pyLDAP.errors.InvalidDN, self.entry.__setitem__, "dn", "invalid")
+        self.assertEqual(str(self.entry.dn), "cn=test,dc=local")
+
     def test_append(self):
         self.entry['givenName'] =  "test"
         self.entry['givenname'].append("test2")
@@ -0,0 +1,85 @@
+import threading
+import unittest
+
+from pyLDAP import LDAPClient
+from pyLDAP.ldappool import LDAPConnectionPool
+import pyLDAP.errors
+import pyLDAP.ldappool
+
+class LDAPConnectionPoolTest(unittest.TestCase):
+    def setUp(self):
+        self.url = "ldap://192.168.1.83/dc=local?cn?sub"
+        self.pool = LDAPConnectionPool(self.url, 4, False, "cn=admin,dc=local", "p@ssword")
+
+    def tearDown(self):
+        self.pool.close()
+        del self.pool
+
+    def test_connection(self):
+        with self.pool.connection() as client:
+            self.assertEqual(client.whoami(), "dn:cn=admin,dc=local")
+            self.assertEqual(self.pool.stats['in_use'], 1)
+        self.assertEqual(self.pool.stats['in_use'], 0)
+        self.assertEqual(self.pool.stats['created'], 4)
+
+    def test_threads(self):
+        results = []
+        def search():
+            for _ in range(10):
+                with self.pool.connection() as client:
+                    results.append(len(client.search()))
+        threads = [threading.Thread(target=search) for _ in range(8)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(len(results), 80)
+        self.assertEqual(len(set(results)), 1)
+        self.assertEqual(self.pool.stats['checkouts'], 80)
+        self.assertEqual(self.pool.stats['created'], 4)
+
+    def test_timeout(self):
+        clients = [self.pool.get() for _ in range(4)]
+        self.assertRaises(TimeoutError, self.pool.get, 0.1)
+        for client in clients:
+            self.pool.put(client)
+
+    def test_dead_connection(self):
+        pool = LDAPConnectionPool(self.url, 1, False, "cn=admin,dc=local", "p@ssword",
+                                  check_interval=0)
+        with pool.connection() as client:
+            client.close()
+        with pool.connection() as client:
+            self.assertEqual(client.whoami(), "dn:cn=admin,dc=local")
+        try:
+            with pool.connection() as client:
+                client.close()
+                client.search()
+        except pyLDAP.errors.NotConnected:
+            pass
+        self.assertEqual(pool.stats['discarded'], 2)
+        with pool.connection() as client:
+            self.assertEqual(client.whoami(), "dn:cn=admin,dc=local")
+        self.assertEqual(pool.stats['created'], 3)
+        pool.close()
+
+    def test_failed_init(self):
+        clients = []
+        class FailingClient(LDAPClient):
+            def connect(self, *args, **kwargs):
+                if len(clients) == 2:
+                    raise pyLDAP.errors.ConnectionError("Test failure.")
+                super().connect(*args, **kwargs)
+                clients.append(self)
+        pyLDAP.ldappool.LDAPClient = FailingClient
+        try:
+            self.assertRaises(pyLDAP.errors.ConnectionError, LDAPConnectionPool, self.url, 4,
+                              False, "cn=admin,dc=local", "p@ssword")
+        finally:
+            pyLDAP.ldappool.LDAPClient = LDAPClient
+        self.assertEqual(len(clients), 2)
+        for client in clients:
+            self.assertRaises(pyLDAP.errors.NotConnected, client.whoami)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,153 @@
+"""
+A minimal LDAP server for testing the ranged retrieval of attribute values.
+
+It serves a single entry, whose `name` attribute is sent in ranges of `size`
+values, like Active Directory does for the attributes with many values
+(e.g. "member;range=0-1499", ..., "member;range=3000-*"). It answers only
+the bind, unbind, abandon, search and modify requests, and records the
+requested attributes of the searches and the modifications it received.
+"""
+import socket
+import threading
+
+def _length(num):
+    if num < 0x80:
+        return bytes([num])
+    octets = num.to_bytes((num.bit_length() + 7) // 8, 'big')
+    return bytes([0x80 | len(octets)]) + octets
+
+def _tlv(tag, content):
+    return bytes([tag]) + _length(len(content)) + content
+
+def _int(num, tag=0x02):
+    return _tlv(tag, num.to_bytes(max(1, (num.bit_length() + 8) // 8), 'big', signed=True))
+
+def _str(text, tag=0x04):
+    return _tlv(tag, text.encode("UTF-8") if isinstance(text, str) else text)
+
+def _seq(*items, tag=0x30):
+    return _tlv(tag, b''.join(items))
+
+def _decode(buf, pos=0):
+    """ Return the tag, the content and the end of the BER element at `pos`. """
+    tag = buf[pos]
+    length = buf[pos + 1]
+    pos += 2
+    if length & 0x80:
+        num = length & 0x7f
+        length = int.from_bytes(buf[pos:pos + num], 'big')
+        pos += num
+    return tag, buf[pos:pos + length], pos + length
+
+def _decode_all(buf):
+    items = []
+    pos = 0
+    while pos < len(buf):
+        tag, content, pos = _decode(buf, pos)
+        items.append((tag, content))
+    return items
+
+class RangeServer:
+    def __init__(self, dn, name, values, size):
+        self.dn = dn
+        self.name = name
+        self.values = values
+        self.size = size
+        self.searches = []
+        self.mods = []
+        self.lock = threading.Lock()
+        self.sock = socket.socket()
+        self.sock.bind(("127.0.0.1", 0))
+        self.sock.listen(8)
+        self.port = self.sock.getsockname()[1]
+        self.conns = []
+        threading.Thread(target=self._accept, daemon=True).start()
+
+    def close(self):
+        """ Stop the server and drop its connections. """
+        self.sock.close()
+        for conn in self.conns:
+            try:
+                conn.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+            conn.close()
+
+    def _accept(self):
+        while True:
+            try:
+                conn, _ = self.sock.accept()
+            except OSError:
+                return
+            self.conns.append(conn)
+            threading.Thread(target=self._serve, args=(conn,), daemon=True).start()
+
+    def _serve(self, conn):
+        buf = b''
+        while True:
+            try:
+                data = conn.recv(65536)
+            except OSError:
+                return
+            if not data:
+                return
+            buf += data
+            while len(buf) > 2:
+                _, content, end = _decode(buf)
+                if end > len(buf):
+                    break
+                buf = buf[end:]
+                parts = _decode_all(content)
+                msgid = int.from_bytes(parts[0][1], 'big')
+                optag, op = parts[1]
+                if optag == 0x42:
+                    conn.close()
+                    return
+                try:
+                    conn.sendall(self._reply(msgid, optag, op))
+                except OSError:
+                    return
+
+    def _result(self, msgid, optag, code=0):
+        return _seq(_int(msgid), _tlv(optag, _int(code, 0x0a) + _str("") + _str("")))
+
+    def _reply(self, msgid, optag, op):
+        if optag == 0x60:
+            return self._result(msgid, 0x61)
+        if optag == 0x66:
+            fields = _decode_all(op)
+            with self.lock:
+                for _, mod in _decode_all(fields[1][1]):
+                    (_, modop), (_, attr) = _decode_all(mod)
+                    (_, name), (_, values) = _decode_all(attr)
+                    self.mods.append((modop[0], name.decode(), [val for _, val in _decode_all(values)]))
+            return self._result(msgid, 0x67)
+        if optag == 0x63:
+            fields = _decode_all(op)
+            attrs = [attr.decode() for _, attr in _decode_all(fields[7][1])]
+            with self.lock:
+                self.searches.append(attrs)
+            if fields[0][1].decode().lower() != self.dn.lower():
+                return self._result(msgid, 0x65, 0x20)
+            return _seq(_int(msgid), _seq(_str(self.dn), self._attributes(attrs), tag=0x64)) \
+                + self._result(msgid, 0x65)
+        return b''
+
+    def _attributes(self, attrs):
+        """ Return the attribute list of the entry for the requested `attrs`. """
+        first = 0
+        for attr in attrs:
+            if attr.lower().startswith(self.name.lower() + ";range="):
+                first = int(attr.split("=")[1].split("-")[0])
+                break
+        else:
+            if attrs and "*" not in attrs and self.name.lower() not in map(str.lower, attrs):
+                return _seq()
+        values = self.values[first:first + self.size]
+        last = first + len(values) - 1
+        name = self.name
+        if first > 0 or len(self.values) > self.size:
+            name = "%s;range=%d-%s" % (self.name, first,
+                "*" if last + 1 >= len(self.values) else last)
+        return _seq(_seq(_str("objectClass"), _tlv(0x31, _str("group"))),
+                    _seq(_str(name), _tlv(0x31, b''.join(_str(val) for val in values))))